@@ -0,0 +1,48 @@
+/**
+ * bench.h - Shared reporting for the performance benchmark suite
+ *
+ * Each benchmark runs a fixed number of iterations on a fixed mesh,
+ * accumulates the cells advanced per step, and writes one
+ * machine-readable results file "<name>.bench":
+ *
+ *   bench: name=<s> steps=<n> cells=<n> time=<s> mcells_s=<rate>
+ *   event: name=<s> calls=<n> time=<s> mcells_s=<rate>
+ *
+ * with one event line per perf_events.h section the benchmark touched.
+ * compare_bench.py diffs these files against the stored baseline/ and
+ * fails on regressions beyond its threshold.
+ */
+
+#include "../part4_parameterization_VF/perf_events.h"
+
+double bench_t0;                     // Wall time at bench_begin()
+long bench_cells = 0;                // Cells advanced, summed over steps
+
+void bench_begin (void)
+{
+    bench_t0 = perf_now();
+}
+
+void bench_end (const char * name, int steps)
+{
+    double wall = perf_now() - bench_t0;
+    if (pid() != 0)
+        return;
+
+    char file[128];
+    sprintf (file, "%s.bench", name);
+    FILE * fp = fopen (file, "w");
+    fprintf (fp, "bench: name=%s steps=%d cells=%ld time=%.6f mcells_s=%.3f\n",
+             name, steps, bench_cells, wall,
+             wall > 0. ? bench_cells/wall/1e6 : 0.);
+    for (int e = 0; e < perf_events_n; e++)
+        fprintf (fp, "event: name=%s calls=%ld time=%.6f mcells_s=%.3f\n",
+                 perf_events[e].name, perf_events[e].calls,
+                 perf_events[e].time,
+                 perf_events[e].time > 0. ?
+                 perf_events[e].cells/perf_events[e].time/1e6 : 0.);
+    fclose (fp);
+
+    fprintf (stderr, "%s: %d steps, %.3f Mcells/s (%.3f s)\n",
+             name, steps, wall > 0. ? bench_cells/wall/1e6 : 0., wall);
+}
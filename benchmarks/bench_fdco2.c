@@ -0,0 +1,65 @@
+/**
+ * bench_fdco2.c - Diffusion-step benchmark
+ *
+ * Fixed-mesh, fixed-iteration variant of part2's Ex1_FDCO2: the
+ * implicit (multigrid) CO2 diffusion step with the pipe injection
+ * source, on a uniform grid with no adaptation or output. Measures
+ * the cost of the diffusion solve.
+ */
+
+#include "run.h"
+#include "diffusion.h"
+#include "bench.h"
+
+#define BENCH_NAME "bench_fdco2"
+#define BENCH_STEPS 200
+
+#define PIPE_RADIUS 0.1         // Pipe injection radius
+
+scalar C[];                     // CO2 concentration
+double D = 1.60e-5;             // CO2 diffusivity in air at 25°C (m²/s)
+
+int main(){
+    L0 = 5.;
+    X0 = -L0/2.;
+    Y0 = -L0/2.;
+    N = 1 << 8;                 // Fixed 256^2 grid
+    DT = 0.25;                  // Implicit: accuracy-limited step
+    run();
+}
+
+event init(t = 0){
+    foreach(){
+        C[] = 400.;             // Atmospheric background
+    }
+    boundary({C});
+    bench_begin();
+}
+
+event injection(i++){
+    perf_begin("injection");
+    foreach(){
+        if (sqrt(sq(x) + sq(y)) < PIPE_RADIUS)
+            C[] = 1500.;
+    }
+    perf_end("injection", grid->n);
+}
+
+event integration(i++) {
+    perf_begin("diffusion");
+    double dt = dtnext(DT);
+    const face vector Dc[] = {D, D};
+    diffusion(C, dt, Dc);
+    perf_end("diffusion", grid->n);
+}
+
+event bench_count(i++)
+{
+    bench_cells += grid->n;
+}
+
+event stop(i = BENCH_STEPS)
+{
+    bench_end(BENCH_NAME, BENCH_STEPS);
+    return 1;                   // Terminate the run
+}
@@ -0,0 +1,58 @@
+/**
+ * bench_green2d.c - Canopy + TKE timestep benchmark
+ *
+ * Fixed-mesh, fixed-iteration variant of the part4 greenhouse case:
+ * the full physics stack (buoyancy, canopy energy balance, implicit
+ * drag, SGS TKE closure, batched tracer diffusion) on a uniform grid
+ * with no adaptation, roof, or output. Measures the cost of the hot
+ * per-step events so regressions in them show up before a deployment.
+ */
+
+#include "navier-stokes/centered.h"
+#include "fractions.h"
+#include "../part4_parameterization_VF/physics.h"
+#include "bench.h"
+
+#define BENCH_NAME "bench_green2d"
+#define BENCH_STEPS 100
+
+int main()
+{
+  // Fixed uniform mesh: no adaptation, so the numbers are comparable
+  // across runs and machines
+  N = 256;
+  L0 = 100;
+  X0 = Y0 = 0;
+
+  a = av;
+  mu = Km;
+  Pr = unityf;
+  b.gradient = minmod2;
+
+  Boundary_C();
+  leaf_BC();
+
+  run();
+}
+
+event init(t = 0)
+{
+  init_physics();
+  geom_cache_update();               // Canopy fractions (computed once)
+  foreach() {
+    TV[] = 295.15;
+    e120[] = Emin;
+  }
+  bench_begin();
+}
+
+event bench_count(i++)
+{
+  bench_cells += grid->n;
+}
+
+event stop(i = BENCH_STEPS)
+{
+  bench_end(BENCH_NAME, BENCH_STEPS);
+  return 1;                          // Terminate the run
+}
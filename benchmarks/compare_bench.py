@@ -0,0 +1,71 @@
+#!/usr/bin/env python3
+"""Compare benchmark results against the stored baseline.
+
+Reads baseline/<name>.bench and the matching fresh <name>/<name>.bench
+produced by `make bench`, compares the overall Mcells/s rate with a
+tolerance, and prints per-event ratios for diagnosis. Exits non-zero if
+any benchmark regressed beyond the threshold, so deployments can gate
+on it.
+"""
+import glob
+import os
+import sys
+
+# A fresh run slower than THRESHOLD x baseline fails the check
+THRESHOLD = 0.90
+
+
+def parse(fname):
+    """Return (bench_dict, {event_name: event_dict}) from a .bench file."""
+    bench, events = None, {}
+    with open(fname) as f:
+        for line in f:
+            kind, _, rest = line.partition(':')
+            kv = dict(item.split('=', 1) for item in rest.split())
+            if kind == 'bench':
+                bench = kv
+            elif kind == 'event':
+                events[kv['name']] = kv
+    return bench, events
+
+
+def main():
+    here = os.path.dirname(os.path.realpath(__file__))
+    baselines = sorted(glob.glob(os.path.join(here, 'baseline', '*.bench')))
+    if not baselines:
+        print("no baseline found - run `make baseline` once to create it")
+        return 1
+
+    failed = False
+    for bfile in baselines:
+        name = os.path.basename(bfile)[:-len('.bench')]
+        nfile = os.path.join(here, name, name + '.bench')
+        if not os.path.exists(nfile):
+            print(f"{name}: MISSING (run `make bench`)")
+            failed = True
+            continue
+
+        base, base_ev = parse(bfile)
+        new, new_ev = parse(nfile)
+        rb = float(base['mcells_s'])
+        rn = float(new['mcells_s'])
+        ratio = rn / rb if rb > 0 else 0.
+        ok = ratio >= THRESHOLD
+        print(f"{name}: {'PASS' if ok else 'FAIL'} "
+              f"{rn:.3f} vs {rb:.3f} Mcells/s ({ratio:.2%} of baseline)")
+        failed |= not ok
+
+        # Per-event breakdown (informational)
+        for ev, kv in sorted(new_ev.items()):
+            if ev in base_ev:
+                tb = float(base_ev[ev]['time'])
+                tn = float(kv['time'])
+                if tb > 0:
+                    print(f"    {ev}: {tn:.3f}s vs {tb:.3f}s "
+                          f"({tn / tb:.2f}x)")
+
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
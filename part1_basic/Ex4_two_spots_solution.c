@@ -31,8 +31,13 @@ int main() {
   double circle_radius2 = 0.3; // Circle radius2
 
   // how should we modify refine function?
-  refine((sq(x - circle_x1) + sq(y - circle_y1) < sq(circle_radius1) ||
-          sq(x - circle_x2) + sq(y - circle_y2) < sq(circle_radius2)) && level < max_level);
+  // (the fabs() tests are a cheap bounding-box check: the tree only
+  // descends into branches near one of the spots, which matters once
+  // max_level gets large)
+  refine(((fabs(x - circle_x1) < circle_radius1 && fabs(y - circle_y1) < circle_radius1 &&
+           sq(x - circle_x1) + sq(y - circle_y1) < sq(circle_radius1)) ||
+          (fabs(x - circle_x2) < circle_radius2 && fabs(y - circle_y2) < circle_radius2 &&
+           sq(x - circle_x2) + sq(y - circle_y2) < sq(circle_radius2))) && level < max_level);
 
   // Initialize temperature field: hot center, cool outside
   foreach() {
@@ -29,7 +29,8 @@
 #include "embed.h"                      // For embedded boundary (the leaf)
 #include "navier-stokes/centered.h"     // For fluid flow equations
 #include "tracer.h"                     // For tracking scalar transport (CO2)
-#include "diffusion.h"                  // For diffusion of CO2
+#include "diffusion.h"                 // For diffusion of CO2
+#include "interface_index.h"           // Cut-cell index for flux diagnostics
 
 // ============================================================================
 // SCALAR FIELD DEFINITION
@@ -91,11 +92,24 @@ event properties (i++) {
   boundary ((scalar*){muc});   // Update boundary conditions for viscosity
 }
 
+// Both initial-refinement bands in one predicate: a two-comparison
+// bounding box rejects cells far from the leaf before the level set is
+// evaluated (the widest band, ELLIPSE < 2.5, reaches ~1.9 semi-axes;
+// the L0/32 margin covers centre sampling on coarse cells), and the
+// level set is evaluated once for both bands, so the whole initial
+// grid is built in a single refine() descent
+static bool leaf_refine_band (double x, double y, int level) {
+  if (fabs(x) > 2.*max(r1, r2) + L0/32. || fabs(y) > 2.*max(r1, r2) + L0/32.)
+    return false;                     // Cheap AABB short-circuit
+  double d = ELLIPSE;
+  return (d < 2.5 && level < maxlevel - 1) ||
+         (d > -0.5 && d < 0.5 && level < maxlevel);
+}
+
 // this event is the initial setup and condition for the simulation
 event init (t = 0) {
-  // refine the local grid
-  refine (ELLIPSE <  2.5 && level  <  maxlevel - 1);
-  refine (ELLIPSE > -0.5 && ELLIPSE <  0.5 && level  <  maxlevel);
+  // refine the local grid: both bands in a single descent
+  refine (leaf_refine_band (x, y, level));
   // initially calculate the elliptical leaf shape
   vertex scalar phi[];
   foreach_vertex()
@@ -117,27 +131,39 @@ event tracer_diffusion (i++) {
 
 // don't worry about this part, it is just a trick to fix the boundary condition
 // for the CO2 concentration and velocity
+static bool sponge_cell (double x, double y) {
+  return x < X0 + L0/5.;              // Forcing band at the inflow side
+}
+Region * sponge = NULL;
+
 event force (i++) {
-  double FB = L0/5., tau = 1;
-  foreach() {
-    if (x < X0 + FB) {
-      s[] -= (s[] - s_in)*dt/tau;
-      u.y[] -= u.y[]*dt/tau;
-      u.x[] -= (u.x[] - wind_in)*dt/tau;
-    }
+  double tau = 1;
+  if (sponge == NULL)                 // Register the sponge region once
+    sponge = region_register (sponge_cell);
+  region_update (sponge);             // Cached list, rebuilt after adaptation
+  for (int ic = 0; ic < sponge->n; ic++) {  // Only cells in the band
+    Point point = region_cell (sponge, ic);  // Cached handle, no tree search
+    s[] -= (s[] - s_in)*dt/tau;
+    u.y[] -= u.y[]*dt/tau;
+    u.x[] -= (u.x[] - wind_in)*dt/tau;
   }
   boundary ({s, u});
 }
 
 // this is the event for adaptive mesh refinement
 // it will refine the grid based on the error tolerance
+#define ADAPT_EVERY 4                   // Reassess the mesh every 4 steps only
 event adapt (i++) {
-  adapt_wavelet ({cs, s, u}, (double[]){5e-1, be, ue,ue}, maxlevel, 5);
+  if (i % ADAPT_EVERY == 0) {           // Per-step mesh changes are tiny
+    astats st = adapt_wavelet ({cs, s, u}, (double[]){5e-1, be, ue,ue}, maxlevel, 5);
+    if (st.nf || st.nc)                 // Mesh changed: cut-cell index is stale
+      interface_index_invalidate();
+  }
 }
 
 // Generate video frames of CO2 concentration field every time unit
+scalar m[];                         // Mask to hide leaf interior in visualization
 event mov (t += 1) {
-  scalar m[];                         // Mask to hide leaf interior in visualization
   foreach()
     m[] = cs[] - 0.5;                 // Positive in fluid, negative in leaf
   boundary ({m});
@@ -151,12 +177,19 @@ event mov (t += 1) {
 // This is the KEY OUTPUT: how much CO2 the leaf maximally can absorb from the air
 // Don't worry about the details of how it is calculated
 event diag_flux (t = 300; t += 1) {
+  interface_index_update();             // Rebuild cut-cell list if mesh changed
   double flx = 0;                       // Total CO2 flux accumulator
-  foreach(reduction(+:flx)) {           // Loop and sum over all grid cells
-    double val = 0, e = embed_flux (point, s, mu, &val);
-    if (val)                            // If cell contains part of leaf boundary
-      flx += (val - e*s[])*sq(Delta);   // Add CO2 flux at this location
+  for (int ic = 0; ic < interface_n; ic++) {  // Only cells cut by the leaf
+    Point point = locate (interface_p[ic].x, interface_p[ic].y);
+    if (point.level >= 0) {
+      double val = 0, e = embed_flux (point, s, mu, &val);
+      if (val)                          // If cell contains part of leaf boundary
+        flx += (val - e*s[])*sq(Delta); // Add CO2 flux at this location
+    }
   }
+@if _MPI
+  MPI_Allreduce (MPI_IN_PLACE, &flx, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+@endif
   static FILE * fp = fopen ("diag1", "w");
   fprintf (fp, "%g %g\n", t, flx);    // Write: time, total_CO2_flux
 }
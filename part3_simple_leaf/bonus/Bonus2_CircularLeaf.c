@@ -22,6 +22,7 @@
 #include "navier-stokes/centered.h"
 #include "tracer.h"
 #include "diffusion.h"
+#include "../interface_index.h"      // Cut-cell index for flux diagnostics
 
 scalar s[], * tracers = {s};
 
@@ -75,10 +76,23 @@ event properties (i++) {
 // ============================================================================
 // INITIALIZATION - Use CIRCLE instead of ELLIPSE
 // ============================================================================
+// Both initial-refinement bands in one predicate: a two-comparison
+// bounding box rejects cells far from the leaf before the level set is
+// evaluated (the widest band, CIRCLE < 2.5, reaches ~1.9 semi-axes;
+// the L0/32 margin covers centre sampling on coarse cells), and the
+// level set is evaluated once for both bands, so the whole initial
+// grid is built in a single refine() descent
+static bool leaf_refine_band (double x, double y, int level) {
+  if (fabs(x) > 2.*r_circle + L0/32. || fabs(y) > 2.*r_circle + L0/32.)
+    return false;                     // Cheap AABB short-circuit
+  double d = CIRCLE;
+  return (d < 2.5 && level < maxlevel - 1) ||
+         (d > -0.5 && d < 0.5 && level < maxlevel);
+}
+
 event init (t = 0) {
-  // Refine mesh around circular leaf
-  refine (CIRCLE <  2.5 && level  <  maxlevel - 1);
-  refine (CIRCLE > -0.5 && CIRCLE <  0.5 && level  <  maxlevel);
+  // Refine mesh around circular leaf: both bands in a single descent
+  refine (leaf_refine_band (x, y, level));
 
   vertex scalar phi[];
   foreach_vertex()
@@ -109,12 +123,17 @@ event force (i++) {
   boundary ({s, u});
 }
 
+#define ADAPT_EVERY 4                   // Reassess the mesh every 4 steps only
 event adapt (i++) {
-  adapt_wavelet ({cs, s, u}, (double[]){5e-1, be, ue,ue}, maxlevel, 5);
+  if (i % ADAPT_EVERY == 0) {           // Per-step mesh changes are tiny
+    astats st = adapt_wavelet ({cs, s, u}, (double[]){5e-1, be, ue,ue}, maxlevel, 5);
+    if (st.nf || st.nc)                 // Mesh changed: cut-cell index is stale
+      interface_index_invalidate();
+  }
 }
 
+scalar m[];                             // Mask reused by every frame
 event mov (t += 1) {
-  scalar m[];
   foreach()
     m[] = cs[] - 0.5;
   boundary ({m});
@@ -124,12 +143,19 @@ event mov (t += 1) {
 }
 
 event diag_flux (t = 300; t += 1) {
-  double flx = 0;
-  foreach(reduction(+:flx)) {
-    double val = 0, e = embed_flux (point, s, mu, &val);
-    if (val)
-      flx += (val - e*s[])*sq(Delta);
+  interface_index_update();             // Rebuild cut-cell list if mesh changed
+  double flx = 0;                       // Total CO2 flux accumulator
+  for (int ic = 0; ic < interface_n; ic++) {  // Only cells cut by the leaf
+    Point point = locate (interface_p[ic].x, interface_p[ic].y);
+    if (point.level >= 0) {
+      double val = 0, e = embed_flux (point, s, mu, &val);
+      if (val)                          // If cell contains part of leaf boundary
+        flx += (val - e*s[])*sq(Delta); // Add CO2 flux at this location
+    }
   }
+@if _MPI
+  MPI_Allreduce (MPI_IN_PLACE, &flx, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+@endif
   static FILE * fp = fopen ("diag1", "w");
   fprintf (fp, "%g %g\n", t, flx);
 }
@@ -23,6 +23,8 @@
 #include "navier-stokes/centered.h"
 #include "tracer.h"
 #include "diffusion.h"
+#include "../interface_index.h"      // Cut-cell index for flux diagnostics
+#include "../leaf_array.h"           // N-leaf geometry with spatial binning
 
 scalar s[], * tracers = {s};
 
@@ -64,12 +66,11 @@ double Y2 = 0.0;            // y-coordinate of second leaf center
 // double X2 = 15.0;  // Wide spacing (spacing = 25)
 // double Y2 = 5.0;   // Offset vertically
 
-// Define two ellipses
-#define LEAF1 (sq((x-X1)/r1) + sq((y-Y1)/r2) - 1.)
-#define LEAF2 (sq((x-X2)/r1) + sq((y-Y2)/r2) - 1.)
-
-// Combined geometry: solid where either leaf is present
-#define BOTH_LEAVES (min(LEAF1, LEAF2))
+// Number of leaves: the default 2 reproduces the original study, any
+// additional leaves are laid out as a downstream row in main()
+#ifndef NLEAVES
+#define NLEAVES 2
+#endif
 
 // ============================================================================
 face vector muc[];
@@ -80,6 +81,15 @@ int main() {
   L0 = 120;
   X0 = Y0 = -L0/2;
   mu = muc;
+
+  // Register the leaves with the array subsystem (the spatial bin
+  // index makes level-set evaluation and flux attribution query only
+  // the leaves near each cell, so hundreds of leaves stay tractable)
+  leaf_add (X1, Y1, r1, r2, 0.);
+  leaf_add (X2, Y2, r1, r2, 0.);
+  for (int l = 2; l < NLEAVES; l++)     // Extra leaves: downstream row
+    leaf_add (X2 + 20.*(l - 1), Y2, r1, r2, 0.);
+
   run();
 }
 
@@ -89,14 +99,24 @@ event properties (i++) {
   boundary ((scalar*){muc});
 }
 
+// Both initial-refinement bands in one predicate, with the level set
+// evaluated once per cell; leaf_levelset() already rejects cells
+// outside the per-leaf bounding boxes via the bin index. The boxes are
+// sized from LEAF_QUERY_BAND, which is also the outer band tested
+// here - keep the two in sync or the coarse band gets truncated.
+static bool leaf_refine_band (double x, double y, int level) {
+  double d = leaf_levelset (x, y);
+  return (d < LEAF_QUERY_BAND && level < maxlevel - 1) ||
+         (d > -0.5 && d < 0.5 && level < maxlevel);
+}
+
 event init (t = 0) {
-  // Refine around both leaves
-  refine (BOTH_LEAVES <  2.5 && level  <  maxlevel - 1);
-  refine (BOTH_LEAVES > -0.5 && BOTH_LEAVES <  0.5 && level  <  maxlevel);
+  // Refine around the leaves: both bands in a single descent
+  refine (leaf_refine_band (x, y, level));
 
   vertex scalar phi[];
   foreach_vertex()
-    phi[] = BOTH_LEAVES;    // Use combined geometry
+    phi[] = leaf_levelset (x, y);       // Combined geometry of all leaves
   boundary ({phi});
   fractions (phi, cs, fs);
 
@@ -123,12 +143,17 @@ event force (i++) {
   boundary ({s, u});
 }
 
+#define ADAPT_EVERY 4                   // Reassess the mesh every 4 steps only
 event adapt (i++) {
-  adapt_wavelet ({cs, s, u}, (double[]){5e-1, be, ue,ue}, maxlevel, 5);
+  if (i % ADAPT_EVERY == 0) {           // Per-step mesh changes are tiny
+    astats st = adapt_wavelet ({cs, s, u}, (double[]){5e-1, be, ue,ue}, maxlevel, 5);
+    if (st.nf || st.nc)                 // Mesh changed: cut-cell index is stale
+      interface_index_invalidate();
+  }
 }
 
+scalar m[];                             // Mask reused by every frame
 event mov (t += 1) {
-  scalar m[];
   foreach()
     m[] = cs[] - 0.5;
   boundary ({m});
@@ -137,34 +162,18 @@ event mov (t += 1) {
 	      box = {{X0 + 15, -15},{X0 + L0, 15}});
 }
 
-// Calculate flux for each leaf separately
+// Calculate flux for each leaf separately: one pass over the cut-cell
+// index fills the whole per-leaf vector, with a single MPI reduction
 event diag_flux (t = 300; t += 1) {
-  double flx_total = 0;     // Total flux (both leaves)
-  double flx_leaf1 = 0;     // Flux to leaf 1 only
-  double flx_leaf2 = 0;     // Flux to leaf 2 only
-
-  foreach(reduction(+:flx_total) reduction(+:flx_leaf1) reduction(+:flx_leaf2)) {
-    double val = 0, e = embed_flux (point, s, mu, &val);
-    if (val) {
-      double flux_contribution = (val - e*s[])*sq(Delta);
-      flx_total += flux_contribution;
-
-      // Determine which leaf this flux belongs to
-      // Check if point is closer to leaf1 or leaf2
-      double dist1 = sqrt(sq(x - X1) + sq(y - Y1));
-      double dist2 = sqrt(sq(x - X2) + sq(y - Y2));
-
-      if (dist1 < dist2) {
-        flx_leaf1 += flux_contribution;
-      } else {
-        flx_leaf2 += flux_contribution;
-      }
-    }
-  }
+  double flx[NLEAVES];
+  double flx_total = leaf_flux (s, flx);
 
   static FILE * fp = fopen ("diag1", "w");
-  // Output: time, total_flux, leaf1_flux, leaf2_flux
-  fprintf (fp, "%g %g %g %g\n", t, flx_total, flx_leaf1, flx_leaf2);
+  // Output: time, total_flux, then one flux per leaf
+  fprintf (fp, "%g %g", t, flx_total);
+  for (int l = 0; l < nleaves; l++)
+    fprintf (fp, " %g", flx[l]);
+  fputc ('\n', fp);
 }
 
 event stop (t = 400);
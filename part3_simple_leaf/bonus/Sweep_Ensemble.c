@@ -0,0 +1,266 @@
+/**
+ * Bonus: Ensemble parameter sweep driver
+ *
+ * Bonus1 (Re) and Bonus3 (concentration) scan parameters by editing,
+ * recompiling and queueing one job per value. This driver runs a whole
+ * sweep in one job: it reads a parameter table ("sweep_params", one
+ * member per line: Re, s_in, s_ls, wind_in, leaf angle in degrees),
+ * and runs each member in its own output directory with a shared flux
+ * summary at the end.
+ *
+ * Parallel mode: compile with the MPI wrapper and -DENSEMBLE_MPI=1 but
+ * WITHOUT -D_MPI=1, e.g.
+ *
+ *   CC='mpicc -DENSEMBLE_MPI=1' make Sweep_Ensemble.tst
+ *   mpirun -np 20 ./Sweep_Ensemble/Sweep_Ensemble
+ *
+ * Each rank then runs serial members round-robin - MPI only places
+ * members and gathers the summary, the grid of every member stays
+ * serial. (The Basilisk grid itself is hard-wired to MPI_COMM_WORLD
+ * under -D_MPI, so true sub-communicator members would need upstream
+ * changes; one serial member per rank gives the same near-perfect
+ * scaling for sweeps of tens of members.) Without ENSEMBLE_MPI the
+ * members simply run one after the other in a single process.
+ */
+
+#include "embed.h"
+#include "navier-stokes/centered.h"
+#include "tracer.h"
+#include "diffusion.h"
+#include "../interface_index.h"      // Cut-cell index for flux diagnostics
+
+#if ENSEMBLE_MPI
+#include <mpi.h>
+#endif
+#include <sys/stat.h>
+#include <unistd.h>
+
+scalar s[], * tracers = {s};
+
+// ============================================================================
+// SIMULATION PARAMETERS
+// ============================================================================
+int maxlevel = 9;
+double ue = 0.05;
+double be = 0.05;
+
+// Member parameters: defaults as in Bonus1, overwritten from the table
+double Re = 50;
+double s_in = 40.0;
+double s_ls = 20.0;
+double wind_in = 1.;
+double theta = 0.;          // Leaf inclination (as in Bonus4)
+
+// ============================================================================
+// BOUNDARY CONDITIONS
+// ============================================================================
+u.t[embed] = dirichlet (0.);
+u.n[embed] = dirichlet (0.);
+s[embed]   = dirichlet (s_ls);
+
+// ============================================================================
+// LEAF GEOMETRY - INCLINED ELLIPSE (see Bonus4)
+// ============================================================================
+double r1 = 5, r2 = 1;
+
+#define ELLIPSE_ROTATED (sq((x*cos(theta) + y*sin(theta))/r1) + \
+                         sq((-x*sin(theta) + y*cos(theta))/r2) - 1.)
+
+// ============================================================================
+face vector muc[];
+
+// ============================================================================
+// PARAMETER TABLE AND MEMBER BOOKKEEPING
+// ============================================================================
+#define SWEEP_MAX 64
+typedef struct {
+  double Re, s_in, s_ls, wind_in, theta;
+} SweepMember;
+SweepMember sweep[SWEEP_MAX];
+int sweep_n = 0;
+int member = -1;            // Member this process is currently running
+double sweep_flx[SWEEP_MAX]; // Latest flux of each member run here
+FILE * diag_fp = NULL;      // Per-member diag1 file
+
+// Read the table: one member per line "Re s_in s_ls wind_in theta_deg",
+// '#' starts a comment
+void sweep_read (const char * file)
+{
+  FILE * fp = fopen (file, "r");
+  if (!fp) {
+    fprintf (stderr, "sweep: cannot open %s\n", file);
+    exit (1);
+  }
+  char line[256];
+  while (fgets (line, 256, fp) && sweep_n < SWEEP_MAX) {
+    if (line[0] == '#')
+      continue;
+    SweepMember * m = &sweep[sweep_n];
+    double deg;
+    if (sscanf (line, "%lf %lf %lf %lf %lf",
+                &m->Re, &m->s_in, &m->s_ls, &m->wind_in, &deg) == 5) {
+      m->theta = M_PI*deg/180.;
+      sweep_n++;
+    }
+  }
+  fclose (fp);
+}
+
+// Point the globals at member m and move into its output directory
+void sweep_select (int m)
+{
+  member = m;
+  Re = sweep[m].Re;
+  s_in = sweep[m].s_in;
+  s_ls = sweep[m].s_ls;
+  wind_in = sweep[m].wind_in;
+  theta = sweep[m].theta;
+
+  char dir[64];
+  sprintf (dir, "member_%02d", m);
+  mkdir (dir, 0777);
+  if (chdir (dir))
+    perror (dir);
+  fprintf (stderr, "sweep: member %d start: Re=%g s_in=%g s_ls=%g "
+           "wind=%g theta=%g deg\n", m, Re, s_in, s_ls, wind_in,
+           theta*180./M_PI);
+}
+
+// Write the shared summary: one line per member with its final flux
+void sweep_summary (const char * file)
+{
+  FILE * fp = fopen (file, "w");
+  fprintf (fp, "# member Re s_in s_ls wind_in theta_deg flux\n");
+  for (int m = 0; m < sweep_n; m++)
+    fprintf (fp, "%d %g %g %g %g %g %g\n", m, sweep[m].Re, sweep[m].s_in,
+             sweep[m].s_ls, sweep[m].wind_in, sweep[m].theta*180./M_PI,
+             sweep_flx[m]);
+  fclose (fp);
+}
+
+int main (int argc, char * argv[]) {
+#if ENSEMBLE_MPI
+  MPI_Init (&argc, &argv);
+#endif
+  sweep_read (argc > 1 ? argv[1] : "sweep_params");
+
+  periodic (left);
+  L0 = 120;
+  X0 = Y0 = -L0/2;
+  mu = muc;
+
+#if ENSEMBLE_MPI
+  int rank, size;
+  MPI_Comm_rank (MPI_COMM_WORLD, &rank);
+  MPI_Comm_size (MPI_COMM_WORLD, &size);
+  // Round-robin member placement: rank r runs members r, r+size, ...
+  for (int m = rank; m < sweep_n; m += size) {
+    sweep_select (m);
+    run();
+    chdir ("..");
+    fprintf (stderr, "sweep: member %d done (flux=%g)\n", m, sweep_flx[m]);
+  }
+  // Every member flux lives on exactly one rank, so a SUM gathers all
+  MPI_Allreduce (MPI_IN_PLACE, sweep_flx, sweep_n, MPI_DOUBLE, MPI_SUM,
+                 MPI_COMM_WORLD);
+  if (rank == 0)
+    sweep_summary ("sweep_summary");
+  MPI_Finalize ();
+#else
+  // No MPI: run the members one after the other
+  for (int m = 0; m < sweep_n; m++) {
+    sweep_select (m);
+    run();
+    chdir ("..");
+    fprintf (stderr, "sweep: member %d done (flux=%g)\n", m, sweep_flx[m]);
+  }
+  sweep_summary ("sweep_summary");
+#endif
+  return 0;
+}
+
+event properties (i++) {
+  foreach_face()
+    muc.x[] = fs.x[]/Re;
+  boundary ((scalar*){muc});
+}
+
+// Both initial-refinement bands in one predicate: a two-comparison
+// bounding box rejects cells far from the leaf before the level set is
+// evaluated (the widest band, ELLIPSE_ROTATED < 2.5, reaches ~1.9 semi-axes;
+// the L0/32 margin covers centre sampling on coarse cells), and the
+// level set is evaluated once for both bands, so the whole initial
+// grid is built in a single refine() descent
+static bool leaf_refine_band (double x, double y, int level) {
+  if (fabs(x) > 2.*max(r1, r2) + L0/32. || fabs(y) > 2.*max(r1, r2) + L0/32.)
+    return false;                     // Cheap AABB short-circuit
+  double d = ELLIPSE_ROTATED;
+  return (d < 2.5 && level < maxlevel - 1) ||
+         (d > -0.5 && d < 0.5 && level < maxlevel);
+}
+
+event init (t = 0) {
+  interface_index_invalidate();         // Fresh grid for this member
+
+  refine (leaf_refine_band (x, y, level));
+
+  vertex scalar phi[];
+  foreach_vertex()
+    phi[] = ELLIPSE_ROTATED;
+  boundary ({phi});
+  fractions (phi, cs, fs);
+
+  foreach(){
+    s[] = cs[] > 0? s_in: 0.;
+    u.x[] = cs[] > 0? wind_in: 0.;
+  }
+  boundary ({s, u.x});
+
+  // Per-member diagnostics file (we are inside member_XX/)
+  if (diag_fp)
+    fclose (diag_fp);
+  diag_fp = fopen ("diag1", "w");
+}
+
+event tracer_diffusion (i++) {
+  diffusion (s, dt, muc);
+}
+
+event force (i++) {
+  double FB = L0/5., tau = 1;
+  foreach() {
+    if (x < X0 + FB) {
+      s[] -= (s[] - s_in)*dt/tau;
+      u.y[] -= u.y[]*dt/tau;
+      u.x[] -= (u.x[] - wind_in)*dt/tau;
+    }
+  }
+  boundary ({s, u});
+}
+
+#define ADAPT_EVERY 4                   // Reassess the mesh every 4 steps only
+event adapt (i++) {
+  if (i % ADAPT_EVERY == 0) {           // Per-step mesh changes are tiny
+    astats st = adapt_wavelet ({cs, s, u}, (double[]){5e-1, be, ue,ue}, maxlevel, 5);
+    if (st.nf || st.nc)                 // Mesh changed: cut-cell index is stale
+      interface_index_invalidate();
+  }
+}
+
+// Flux diagnostic: per-member diag1 plus the value for the summary
+event diag_flux (t = 300; t += 1) {
+  interface_index_update();             // Rebuild cut-cell list if mesh changed
+  double flx = 0;
+  for (int ic = 0; ic < interface_n; ic++) {
+    Point point = locate (interface_p[ic].x, interface_p[ic].y);
+    if (point.level >= 0) {
+      double val = 0, e = embed_flux (point, s, mu, &val);
+      if (val)
+        flx += (val - e*s[])*sq(Delta);
+    }
+  }
+  fprintf (diag_fp, "%g %g\n", t, flx);
+  sweep_flx[member] = flx;              // Last value goes to the summary
+}
+
+event stop (t = 400);
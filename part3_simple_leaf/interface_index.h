@@ -0,0 +1,114 @@
+/**
+ * interface_index.h - Compact index of embedded-boundary cut cells
+ *
+ * The flux diagnostics used to loop over every cell of the 120x120
+ * domain calling embed_flux() just to find the few hundred cells cut
+ * by the leaf. This header maintains a compact list of the locally
+ * owned cut cells (0 < cs < 1), rebuilt lazily after the mesh has
+ * changed, so diagnostics iterate O(interface) instead of O(domain).
+ * The same caching pattern is exposed generically for coordinate
+ * regions (region_register()/region_update()), used by the forcing
+ * sponge events.
+ *
+ * Usage:
+ *   - call interface_index_invalidate() when adapt_wavelet changes the
+ *     mesh (the adapt events do this);
+ *   - call interface_index_update() before reading the list;
+ *   - iterate the interface_n entries of interface_p[]; locate() on an
+ *     entry yields the Point required by embed_flux().
+ */
+
+coord * interface_p = NULL;          // Centres of locally owned cut cells
+int interface_n = 0;                 // Number of indexed cells
+static int interface_max = 0;        // Allocated capacity
+static bool interface_dirty = true;  // Needs rebuilding
+
+// ============================================================
+// Generic coordinate-region index
+// ============================================================
+// Same caching pattern for regions defined by a coordinate predicate,
+// e.g. the forcing sponge near the inflow boundary: register the
+// predicate once, and iterate the cached member list instead of
+// scanning the whole mesh every step. The list stores the cell handles
+// captured during the rebuild traversal - they stay valid exactly as
+// long as the mesh is unchanged, i.e. the lifetime of the list, so
+// iterating is a direct stencil access with no per-step tree search.
+// interface_index_invalidate() marks these stale too, so the adapt
+// events need no extra calls.
+
+typedef bool (*region_pred)(double x, double y);
+
+typedef struct {
+    region_pred pred;                // Membership predicate
+    Point * cells;                   // Locally owned member cells
+    int n;                           // Number of indexed cells
+    int max;                         // Allocated capacity
+    bool dirty;                      // Needs rebuilding
+} Region;
+
+#define REGION_MAX 4
+static Region regions[REGION_MAX];
+static int region_n = 0;
+
+// Register a region (done once, lazily, by the event that uses it)
+Region * region_register(region_pred pred)
+{
+    assert (region_n < REGION_MAX);
+    Region * r = &regions[region_n++];
+    r->pred = pred;
+    r->cells = NULL;
+    r->n = r->max = 0;
+    r->dirty = true;
+    return r;
+}
+
+// Rebuild the member cell list if the mesh changed since the last
+// call, capturing the handle of each member cell
+void region_update(Region * r)
+{
+    if (!r->dirty)
+        return;
+
+    r->n = 0;
+    foreach(serial)
+        if (r->pred(x, y)) {
+            if (r->n == r->max) {
+                r->max = r->max ? 2*r->max : 256;
+                r->cells = (Point *) realloc (r->cells, r->max*sizeof(Point));
+            }
+            r->cells[r->n++] = point;
+        }
+    r->dirty = false;
+}
+
+// Point of the ic-th entry (valid until the next invalidation)
+#define region_cell(r, ic) ((r)->cells[ic])
+
+// Mark the index stale (cheap; called after mesh changes)
+void interface_index_invalidate()
+{
+    interface_dirty = true;
+    for (int q = 0; q < region_n; q++)
+        regions[q].dirty = true;
+}
+
+// Rebuild the cut-cell list if the mesh changed since the last call
+void interface_index_update()
+{
+    if (!interface_dirty)
+        return;
+
+    interface_n = 0;
+    foreach(serial)
+        if (cs[] > 0. && cs[] < 1.) {
+            if (interface_n == interface_max) {
+                interface_max = interface_max ? 2*interface_max : 256;
+                interface_p = (coord *) realloc (interface_p,
+                                                 interface_max*sizeof(coord));
+            }
+            interface_p[interface_n].x = x;
+            interface_p[interface_n].y = y;
+            interface_n++;
+        }
+    interface_dirty = false;
+}
@@ -0,0 +1,174 @@
+/**
+ * leaf_array.h - Array-of-leaves geometry with a spatial bin index
+ *
+ * Bonus5 hard-coded two elliptical leaves and attributed flux with a
+ * per-cell distance test against both centers. Both patterns are
+ * O(cells x leaves): with hundreds of leaves, evaluating min over all
+ * level sets per vertex dominates initialisation and the per-cut-cell
+ * attribution dominates the diagnostics.
+ *
+ * This header keeps the leaves in an array and bins their padded
+ * bounding boxes into a coarse uniform grid over the domain. Level-set
+ * evaluation and nearest-leaf queries only visit the leaves whose
+ * boxes overlap the query point's bin, so the cost per cell is the
+ * local leaf density, not the total leaf count. leaf_flux() produces
+ * the whole per-leaf flux vector in one pass over the cut-cell index
+ * (interface_index.h) with a single MPI reduction.
+ *
+ * Usage: leaf_add() each leaf before init, build the geometry from
+ * leaf_levelset(x, y), and call leaf_flux() in the diagnostics.
+ */
+
+typedef struct {
+  double x, y;                          // Leaf center
+  double r1, r2;                        // Ellipse semi-axes
+  double theta;                         // Inclination angle [rad]
+} Leaf;
+
+Leaf * leaves = NULL;                   // All registered leaves
+int nleaves = 0;
+static int leaves_max = 0;
+
+// Coarse bin grid over the domain: each bin lists the leaves whose
+// padded bounding box overlaps it
+#define LEAF_BINS 16
+
+// Widest level-set band any caller queries: the coarse initial
+// refinement band tests leaf_levelset() < LEAF_QUERY_BAND (Bonus5).
+// The quadratic ellipse level set reaches that value a factor
+// sqrt(1 + LEAF_QUERY_BAND) of a semi-axis from the center, so the
+// bounding boxes are sized from this constant - a fixed pad smaller
+// than that would return HUGE for points still inside the band and
+// silently truncate the refinement region.
+#define LEAF_QUERY_BAND 2.5
+static int * leaf_bin_idx[LEAF_BINS*LEAF_BINS];
+static int leaf_bin_n[LEAF_BINS*LEAF_BINS];
+static bool leaf_index_built = false;
+
+// Register one leaf; returns its index (the order of the flux vector)
+int leaf_add (double x, double y, double r1, double r2, double theta)
+{
+  if (nleaves == leaves_max) {
+    leaves_max = leaves_max ? 2*leaves_max : 16;
+    leaves = (Leaf *) realloc (leaves, leaves_max*sizeof(Leaf));
+  }
+  Leaf * l = &leaves[nleaves];
+  l->x = x, l->y = y, l->r1 = r1, l->r2 = r2, l->theta = theta;
+  leaf_index_built = false;             // Bins are stale
+  return nleaves++;
+}
+
+// Level set of a single leaf at (xp, yp): rotated ellipse, positive
+// outside (fluid), negative inside, like the ELLIPSE macros
+static double leaf_phi1 (const Leaf * l, double xp, double yp)
+{
+  double dx = xp - l->x, dy = yp - l->y;
+  double c = cos(l->theta), sn = sin(l->theta);
+  double xr = dx*c + dy*sn, yr = -dx*sn + dy*c;
+  return sq(xr/l->r1) + sq(yr/l->r2) - 1.;
+}
+
+// (Re)build the bin grid: every leaf is inserted into all bins its
+// padded bounding box overlaps
+static void leaf_index_build (void)
+{
+  for (int bq = 0; bq < LEAF_BINS*LEAF_BINS; bq++) {
+    free (leaf_bin_idx[bq]);
+    leaf_bin_idx[bq] = NULL;
+    leaf_bin_n[bq] = 0;
+  }
+  for (int l = 0; l < nleaves; l++) {
+    double R = sqrt(1. + LEAF_QUERY_BAND)*max(leaves[l].r1, leaves[l].r2);
+    int i0 = clamp((int)((leaves[l].x - R - X0)/L0*LEAF_BINS), 0, LEAF_BINS - 1);
+    int i1 = clamp((int)((leaves[l].x + R - X0)/L0*LEAF_BINS), 0, LEAF_BINS - 1);
+    int j0 = clamp((int)((leaves[l].y - R - Y0)/L0*LEAF_BINS), 0, LEAF_BINS - 1);
+    int j1 = clamp((int)((leaves[l].y + R - Y0)/L0*LEAF_BINS), 0, LEAF_BINS - 1);
+    for (int bi = i0; bi <= i1; bi++)
+      for (int bj = j0; bj <= j1; bj++) {
+        int bq = bi*LEAF_BINS + bj;
+        leaf_bin_idx[bq] = (int *) realloc (leaf_bin_idx[bq],
+                                            (leaf_bin_n[bq] + 1)*sizeof(int));
+        leaf_bin_idx[bq][leaf_bin_n[bq]++] = l;
+      }
+  }
+  leaf_index_built = true;
+}
+
+// Bin holding the point (xp, yp)
+static int leaf_bin_of (double xp, double yp)
+{
+  int bi = clamp((int)((xp - X0)/L0*LEAF_BINS), 0, LEAF_BINS - 1);
+  int bj = clamp((int)((yp - Y0)/L0*LEAF_BINS), 0, LEAF_BINS - 1);
+  return bi*LEAF_BINS + bj;
+}
+
+// Combined level set: min over the leaves binned near the point only.
+// Points outside every bounding box return a large positive (fluid)
+// value - only the zero crossing matters for fractions()
+double leaf_levelset (double xp, double yp)
+{
+  if (!leaf_index_built)
+    leaf_index_build();
+  int bq = leaf_bin_of (xp, yp);
+  double phi = HUGE;
+  for (int k = 0; k < leaf_bin_n[bq]; k++) {
+    double p = leaf_phi1 (&leaves[leaf_bin_idx[bq][k]], xp, yp);
+    if (p < phi)
+      phi = p;
+  }
+  return phi;
+}
+
+// Nearest leaf to (xp, yp) among the locally binned candidates (every
+// cut cell sits inside at least one padded bounding box); falls back
+// to a full scan for points outside all boxes
+int leaf_nearest (double xp, double yp)
+{
+  if (!leaf_index_built)
+    leaf_index_build();
+  int bq = leaf_bin_of (xp, yp);
+  int best = -1;
+  double dbest = HUGE;
+  int nc = leaf_bin_n[bq];
+  for (int k = 0; k < (nc ? nc : nleaves); k++) {
+    int l = nc ? leaf_bin_idx[bq][k] : k;
+    double d = sq(xp - leaves[l].x) + sq(yp - leaves[l].y);
+    if (d < dbest) {
+      dbest = d;
+      best = l;
+    }
+  }
+  return best;
+}
+
+// Per-leaf embedded flux of scalar s in one pass over the cut-cell
+// index: flx must hold nleaves entries, each gets its leaf's share and
+// the total is returned. One reduction for the whole vector under MPI.
+double leaf_flux (scalar s, double * flx)
+{
+  interface_index_update();             // Rebuild cut-cell list if stale
+  for (int l = 0; l < nleaves; l++)
+    flx[l] = 0.;
+
+  for (int ic = 0; ic < interface_n; ic++) {
+    Point point = locate (interface_p[ic].x, interface_p[ic].y);
+    if (point.level < 0)
+      continue;
+    double val = 0, e = embed_flux (point, s, mu, &val);
+    if (val) {
+      int l = leaf_nearest (interface_p[ic].x, interface_p[ic].y);
+      if (l >= 0)
+        flx[l] += (val - e*s[])*sq(Delta);
+    }
+  }
+
+@if _MPI
+  MPI_Allreduce (MPI_IN_PLACE, flx, nleaves, MPI_DOUBLE, MPI_SUM,
+                 MPI_COMM_WORLD);
+@endif
+
+  double total = 0.;
+  for (int l = 0; l < nleaves; l++)
+    total += flx[l];
+  return total;
+}
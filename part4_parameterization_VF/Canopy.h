@@ -10,6 +10,8 @@
  */
 
 #include "fractions.h"
+#include "geometry_cache.h"
+#include "region_index.h"
 
 // ============================================================
 // CANOPY GEOMETRY - Three discrete cube elements
@@ -30,6 +32,23 @@ face vector fCL[];                   // Canopy face fraction field
 #define PAD(s) 1.20                  // Plant area density [m^2/m^3]
 #define Cd 0.20                      // Drag coefficient (Shaw & Schumann 1992)
 
+// ------------------------------------------------------------
+// Vertical lookup tables for the drag and source kernels
+// ------------------------------------------------------------
+// Production setups replace the constant PAD(s) with a measured
+// vertical profile (piecewise polynomial in y), and re-evaluating that
+// profile per cell per step inside the drag, wake-production and
+// source loops is what those kernels then pay for. The profile only
+// depends on y, so canopy_tables_init() samples it once into a
+// vertical table and the kernels read one value: PAD_AT(y), and
+// CDPAD_AT(y) for the premultiplied Cd*PAD.
+#define PAD_NBINS 256
+static double PAD_tab[PAD_NBINS], CdPAD_tab[PAD_NBINS];
+
+#define PAD_BIN(s) ((int) clamp(((s) - Y0)/L0*PAD_NBINS, 0, PAD_NBINS - 1))
+#define PAD_AT(s) PAD_tab[PAD_BIN(s)]
+#define CDPAD_AT(s) CdPAD_tab[PAD_BIN(s)]
+
 // ============================================================
 // PHYSICAL CONSTANTS
 // ============================================================
@@ -50,6 +69,11 @@ face vector fCL[];                   // Canopy face fraction field
 #define T_s 295.15                   // Sky temperature [K]
 #define T_g 295.15                   // Ground temperature [K]
 
+// Precomputed radiation constants (filled by leaf_BC): the sky/ground
+// part of Lwin does not depend on TV, and the TV^4 terms of Lwin and
+// Lwout combine, so Lwnet = Lwin_const + Lwnet_tv4 * TV^4
+static double Lwin_const = 0., Lwnet_tv4 = 0.;
+
 // ============================================================
 // LEAF PROPERTIES
 // ============================================================
@@ -73,35 +97,22 @@ scalar TV[];                         // Leaf temperature [K]
 scalar H[];                          // Convective heat flux [W m^-2]
 scalar QE[];                         // Transpiration flux [kg m^-2 s^-1]
 scalar Lwnet[];                      // Net longwave radiation [W m^-2]
+scalar TV_rad[];                     // TV at the last radiation evaluation [K]
+
+// Leaf temperature drift that triggers a longwave re-evaluation [K]
+#define LEAF_RAD_TOL 0.05
 
 // Transpiration parameters
 double cw_sat = 1.28;                // Saturation water vapor concentration
 double rs = 231.;                    // Stomatal resistance [s m^-1]
 
 // ============================================================
-// FUNCTION: leaf_BC - Set boundary conditions for canopy fields
+// FUNCTION: canopy_phi - Level set of the three canopy cubes
 // ============================================================
-void leaf_BC()
+// Used by the geometry cache: the cubes are static, so this is only
+// re-evaluated when the mesh has changed.
+void canopy_phi (vertex scalar phi)
 {
-    TV.refine = refine_injection;
-    TV.coarsen = refine_injection;
-    H.refine = refine_injection;
-    H.coarsen = refine_injection;
-    QE.refine = refine_injection;
-    QE.coarsen = refine_injection;
-    CL.refine = refine_injection;
-    CL.coarsen = refine_injection;
-}
-
-// ============================================================
-// EVENT: leaf_flow - Compute canopy geometry and energy balance
-// ============================================================
-event leaf_flow(i++)
-{
-    // ------------------------------------------------------------
-    // STEP 1: Define canopy geometry using fractions method
-    // ------------------------------------------------------------
-    vertex scalar phi[];
     foreach_vertex() {
         // Define three cubes as level set functions (positive inside, negative outside)
         double cube1 = intersection(intersection(
@@ -122,62 +133,141 @@ event leaf_flow(i++)
         // Union: combine all three cubes
         phi[] = union(union(cube1, cube2), cube3);
     }
+}
+
+// ============================================================
+// FUNCTION: leaf_BC - Set boundary conditions for canopy fields
+// ============================================================
+void leaf_BC()
+{
+    TV.refine = refine_injection;
+    TV.coarsen = refine_injection;
+    H.refine = refine_injection;
+    H.coarsen = refine_injection;
+    QE.refine = refine_injection;
+    QE.coarsen = refine_injection;
+    CL.refine = refine_injection;
+    CL.coarsen = refine_injection;
+    TV_rad.refine = refine_injection;
+    TV_rad.coarsen = refine_injection;
+
+    // Sample the vertical plant-area-density profile into the lookup
+    // tables (L0/Y0 are set by now; the profile is static)
+    for (int q = 0; q < PAD_NBINS; q++) {
+        double yq = Y0 + (q + 0.5)*L0/PAD_NBINS;
+        PAD_tab[q] = PAD(yq);
+        CdPAD_tab[q] = Cd * PAD_tab[q];
+    }
 
-    // Compute volume and face fractions from level set
-    fractions(phi, CL, fCL);
-    boundary({CL});
+    // Precompute the radiation constants used by leaf_flow
+    Lwin_const = 0.5 * VF_s * eps_s * boltz * pow(T_s, 4) +
+                 0.5 * VF_g * eps_g * boltz * pow(T_g, 4);
+    Lwnet_tv4 = eps_l * boltz * (VF_l - 1.);
+
+    // Register the canopy cubes with the geometry cache
+    geom_register (canopy_phi, CL, fCL);
+}
+
+// ============================================================
+// EVENT: leaf_flow - Compute canopy geometry and energy balance
+// ============================================================
+// Cached canopy cell list: the energy balance only has work where
+// CL[] > 0, so iterating the cached list skips the >70% of the mesh
+// the full traversal used to stream through
+static bool canopy_cell(Point point)
+{
+    return CL[] > 0.;
+}
+Region * canopy_region = NULL;
+
+event leaf_flow(i++)
+{
+    perf_begin("leaf_flow");
 
     // ------------------------------------------------------------
-    // STEP 2: Compute longwave radiation balance
+    // STEP 1: Update canopy geometry (no-op while the mesh is unchanged)
     // ------------------------------------------------------------
-    foreach() {
-        Lwnet[] = 0.;
-        if (CL[] > 0.) {
-            // Incoming longwave from sky, ground, and surrounding leaves
-            double Lwin = 0.5 * VF_s * eps_s * boltz * pow(T_s, 4) +
-                          0.5 * VF_g * eps_g * boltz * pow(T_g, 4) +
-                          1.0 * VF_l * eps_l * boltz * pow(TV[], 4);
-
-            // Outgoing longwave from leaf surface
-            double Lwout = eps_l * boltz * pow(TV[], 4);
-
-            // Net longwave radiation
-            Lwnet[] = Lwin - Lwout;
+    geom_cache_update();
+
+    // ------------------------------------------------------------
+    // STEP 2: Refresh the canopy cell list if the mesh changed
+    // ------------------------------------------------------------
+    if (canopy_region == NULL)
+        canopy_region = region_register(canopy_cell);
+    if (region_dirty(canopy_region)) {
+        // Cells that left the canopy after the mesh change would keep
+        // stale fluxes (the profiles accumulate H and QE unguarded).
+        // Zeroing Lwnet[] alone would leave the lazy guard below
+        // disarmed (TV_rad[] still equals TV[]), so the energy balance
+        // would run with no radiation until TV drifted LEAF_RAD_TOL;
+        // resetting TV_rad[] forces a re-evaluation on the first visit.
+        foreach() {
+            H[] = 0.;
+            QE[] = 0.;
+            Lwnet[] = 0.;
+            TV_rad[] = -HUGE;
         }
     }
+    region_update(canopy_region);
 
     // ------------------------------------------------------------
-    // STEP 3: Compute convective heat exchange and transpiration
+    // STEP 3: Fused energy balance - radiation, convection, leaf
+    // temperature and transpiration over the canopy cells only
     // ------------------------------------------------------------
-    foreach () {
-        H[] = 0.;
-        QE[] = 0.;
+    for (int ic = 0; ic < canopy_region->n; ic++) {
+        // Cached cell handle, valid until the next mesh change (same
+        // lifetime as the list itself)
+        Point point = region_cell(canopy_region, ic);
 
-        if (CL[] > 0.) {
-            // Air temperature from buoyancy field
-            double T_a = b[] * T_ref / Gconst + T_ref;
+        // Lazy longwave balance: the radiation terms only move with
+        // TV, so this is re-evaluated only once TV has drifted past
+        // LEAF_RAD_TOL since the last evaluation. The sky/ground
+        // part and the TV^4 coefficient are precomputed in leaf_BC,
+        // leaving one TV^4 per evaluation.
+        if (fabs(TV[] - TV_rad[]) > LEAF_RAD_TOL) {
+            Lwnet[] = Lwin_const + Lwnet_tv4 * sq(sq(TV[]));
+            TV_rad[] = TV[];
+        }
 
-            // Buoyancy parameter for mixed convection
-            double gstar = Gconst * (TV[] - T_a) / T_a;
+        // Air temperature from buoyancy field
+        double T_a = b[] * T_ref / Gconst + T_ref;
 
-            // Effective velocity including buoyancy effects
-            double M = sqrt(sq(u.x[]) + sq(u.y[]) + fabs(2 * L_l * gstar));
+        // Buoyancy parameter for mixed convection
+        double gstar = Gconst * (TV[] - T_a) / T_a;
 
-            // Reynolds and Nusselt numbers for heat transfer
-            double Re = fabs(M) * L_l / vis;
-            double Nu = (Re > 2E4) ? 0.032 * pow(Re, 0.8) : 0.6 * pow(Re, 0.5);
+        // Effective velocity including buoyancy effects
+#if dimension == 3
+        double M = sqrt(sq(u.x[]) + sq(u.y[]) + sq(u.z[]) +
+                        fabs(2 * L_l * gstar));
+#else
+        double M = sqrt(sq(u.x[]) + sq(u.y[]) + fabs(2 * L_l * gstar));
+#endif
 
-            // Aerodynamic resistance
-            double rH = L_l / Nu / Kd * Cp_a * rho_a;
+        // Reynolds and Nusselt numbers for heat transfer
+        double Re = fabs(M) * L_l / vis;
+        double Nu = (Re > 2E4) ? 0.032 * pow(Re, 0.8) : 0.6 * pow(Re, 0.5);
 
-            // Convective heat flux [W m^-2]
-            H[] = Cp_a * rho_a / rH * (TV[] - T_a);
+        // Aerodynamic resistance and convective exchange coefficient
+        double rH = L_l / Nu / Kd * Cp_a * rho_a;
+        double c_conv = Cp_a * rho_a / rH;
 
-            // Update leaf temperature (forward Euler)
-            TV[] += dt * (Lwnet[] - H[]) * A_l / (Cp_l * V_l);
+        // Convective heat flux [W m^-2]
+        H[] = c_conv * (TV[] - T_a);
 
-            // Transpiration flux [kg m^-2 s^-1]
-            QE[] = (cw_sat - cw[]) / (rH + rs);
-        }
+        // Update leaf temperature: backward Euler on the
+        // linearization of H and Lwnet around TV_n,
+        //   dH/dTV    = c_conv
+        //   dLwnet/dTV = 4*Lwnet_tv4*TV^3  (negative: VF_l < 1)
+        // so the update is unconditionally stable and the flow dt
+        // is never limited by the leaf thermal time constant
+        double gam = A_l / (Cp_l * V_l);
+        double denom = 1. + dt * gam *
+            (c_conv - 4. * Lwnet_tv4 * cube(TV[]));
+        TV[] += dt * gam * (Lwnet[] - H[]) / denom;
+
+        // Transpiration flux [kg m^-2 s^-1]
+        QE[] = (cw_sat - cw[]) / (rH + rs);
     }
+
+    perf_end("leaf_flow", canopy_region->n);
 }
\ No newline at end of file
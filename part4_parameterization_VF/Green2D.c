@@ -8,18 +8,32 @@
 #include "navier-stokes/centered.h"
 #include "fractions.h"
 #include "output_slices.h"
+#include "incremental_dump.h"
+#include "fast_restore.h"
 #include "view.h"
 
 // Simulation parameters
 int maxlevel, minlevel;              // Grid refinement levels
 double eps;                          // Adaptation criterion
 double TEND = 80.;                    // Simulation end time [s]
+#define DUMP_DT 10.                  // Checkpoint interval [s]
 
 #include "physics.h"
+#include "profiles.h"                // In-situ averaged vertical profiles
+#include "load_balance.h"            // Canopy-weighted rank-imbalance monitor
 
 // Output directory settings
 char filedir[200] = "/home/dai/Documents/talks/workshop_Shanghai_oct_30/tutorial/part4_parameterization_VF/";
 char W12dir[230];
+char framedir[230];
+
+// Movie pipeline: by default each frame is staged as a compact v2
+// field snapshot (background writer, no OpenGL in the solver loop) and
+// rendered afterwards with render_frames.py; compile with
+// -DLIVE_MOVIES=1 to get the old in-loop bview mp4 rendering instead
+#ifndef LIVE_MOVIES
+#define LIVE_MOVIES 0
+#endif
 
 // ============================================================
 // GREENHOUSE ROOF PARAMETERS
@@ -34,6 +48,39 @@ face vector fROOF[];                 // Roof face fraction field
 #define ROOF_WAVE_NUMBER (2.*M_PI*NUM_WAVES/L0)  // Wave number [rad/m]
 #define ROOF_VAL 0.5                 // Smoothing parameter for fractions
 
+// ============================================================
+// ADAPTATION SCHEDULER PARAMETERS
+// ============================================================
+// Bounding box for noise seeding: the canopy region (the rest of the
+// domain needs no extra stimulation to refine)
+#define ADAPT_X_MIN 15.              // Left edge of noise box [m]
+#define ADAPT_X_MAX 85.              // Right edge of noise box [m]
+#define ADAPT_Y_MAX 35.              // Top of noise box, just above Zh [m]
+#define ADAPT_BOX(x, y) ((x) >= ADAPT_X_MIN && (x) <= ADAPT_X_MAX && \
+                         (y) <= ADAPT_Y_MAX)
+
+// Auto-tuned adaptation interval: the wavelet assessment runs every
+// adapt_every steps, growing the interval while the mesh-change
+// fraction stays small and shrinking it when changes spike
+int adapt_every = 1;                 // Current interval between adaptations
+#define ADAPT_EVERY_MAX 8            // Upper bound on the interval
+#define ADAPT_FRAC_HI 0.01           // Change fraction that halves the interval
+#define ADAPT_FRAC_LO 0.002          // Change fraction that grows the interval
+
+// Level set of the wavy roof, used by the geometry cache so the
+// fractions are only rebuilt when the mesh changes
+void roof_phi(vertex scalar phi)
+{
+    foreach_vertex() {
+        // Roof height as function of x: y_roof(x) = center + amplitude * cos(k*x)
+        double y_roof = ROOF_Y_CENTER + ROOF_AMPLITUDE * cos(ROOF_WAVE_NUMBER * x);
+
+        // Level set: positive inside roof (y > y_roof), negative outside
+        // Distance from point to roof surface
+        phi[] = y - y_roof;
+    }
+}
+
 // ============================================================
 // MAIN FUNCTION - Set up simulation parameters
 // ============================================================
@@ -64,6 +111,9 @@ int main()
   Boundary_C();                      // Set physics boundary conditions
   leaf_BC();                         // Set canopy boundary conditions
 
+  // Register the static roof with the geometry cache
+  geom_register(roof_phi, ROOF, fROOF);
+
   run();
 }
 
@@ -72,11 +122,14 @@ int main()
 // ============================================================
 void sim_dir_create(){
     sprintf(W12dir, "%sW12/", filedir);
-    if (pid() == 0)                  // Only master process creates directory
+    sprintf(framedir, "%sframes/", filedir);
+    if (pid() == 0)                  // Only master process creates directories
     {
         struct stat st = {0};
         if (stat(W12dir, &st) == -1)
             mkdir(W12dir, 0777);
+        if (stat(framedir, &st) == -1)
+            mkdir(framedir, 0777);
     }
 }
 
@@ -85,15 +138,33 @@ void sim_dir_create(){
 // ============================================================
 event init(t = 0)
 {
-    init_physics();                  // Initialize physical fields from physics.h
     sim_dir_create();                // Create output directory
 
+#ifdef RESTORE_FILE
+    // Crash recovery: restart from a checkpoint base (compile with
+    // e.g. -DRESTORE_FILE='"dump-000.base"'). The mmap-backed restore
+    // reuses page cache across rapid successive restarts. The deltas
+    // written after the base are then replayed in order; the last one
+    // found sets t, so the run resumes from the newest checkpoint
+    // rather than from the base itself.
+    if (fast_restore(file = RESTORE_FILE)) {
+        for (double td = DUMP_DT; td <= TEND; td += DUMP_DT) {
+            char dname[80];
+            sprintf(dname, "dump-%03d", (int)td);
+            if (idump_replay(dname, NULL) < 0)
+                break;               // No newer delta: restart point reached
+        }
+        geom_invalidate(-1);         // Cached fractions are not dumped
+        return 0;
+    }
+#endif
+
+    init_physics();                  // Initialize physical fields from physics.h
+
     // Add noise for initial turbulence in the canopy region
-    scalar n[];
+    scalar n = scratch_checkout();
     foreach () {
-        n[] = 0.;
-        if (x <= 85. && x >= 15. && y < 35. && y > 65.)
-            n[] = noise();
+        n[] = ADAPT_BOX(x, y) ? noise() : 0.;
     }
 
     // Adapt grid based on initial conditions
@@ -107,6 +178,8 @@ event init(t = 0)
         }
     }
 
+    scratch_release(n);
+
     // Initialize canopy variables
     foreach() {
         TV[] = 295.15;               // Leaf temperature [K]
@@ -115,33 +188,36 @@ event init(t = 0)
 }
 
 // ============================================================
-// EVENT: ROOF - Calculate roof fraction and damp velocity
+// EVENT: ROOF - Update cached roof fraction and damp velocity
 // ============================================================
-event roof(i++)
+// Cached roof cell list: the roof is static, so between mesh changes
+// the damping only needs to visit the cells actually inside it
+static bool roof_cell(Point point)
 {
-    // Define level set for wavy roof using fractions method
-    vertex scalar phi[];
-    foreach_vertex() {
-        // Roof height as function of x: y_roof(x) = center + amplitude * cos(k*x)
-        double y_roof = ROOF_Y_CENTER + ROOF_AMPLITUDE * cos(ROOF_WAVE_NUMBER * x);
+    return ROOF[] > 0.5;             // More than 50% inside roof
+}
+Region * roof_region = NULL;
 
-        // Level set: positive inside roof (y > y_roof), negative outside
-        // Distance from point to roof surface
-        phi[] = y - y_roof;
-    }
+event roof(i++)
+{
+    perf_begin("roof");
 
-    // Compute volume and face fractions from level set
-    fractions(phi, ROOF, fROOF);
+    // Recompute the cached fractions only if adaptation touched the mesh
+    geom_cache_update();
 
     // Damp velocity in roof region
-    foreach() {
-        if (ROOF[] > 0.5) {          // If more than 50% inside roof
-            u.x[] = 0.;              // Damp horizontal velocity
-            u.y[] = 0.;              // Damp vertical velocity
-        }
+    if (roof_region == NULL)
+        roof_region = region_register(roof_cell);
+    region_update(roof_region);
+    for (int ic = 0; ic < roof_region->n; ic++) {
+        Point point = region_cell(roof_region, ic);
+        u.x[] = 0.;                  // Damp horizontal velocity
+        u.y[] = 0.;                  // Damp vertical velocity
     }
 
     boundary({ROOF, u});
+
+    perf_end("roof", roof_region->n);
 }
 
 // ============================================================
@@ -149,18 +225,54 @@ event roof(i++)
 // ============================================================
 event adapt(i++)
 {
-    // Add noise near canopy for better refinement
-    scalar n[];
-    foreach() {
-        n[] = 0.;
-        if (x <= 85. && x >= 15. && y < 35. && y > 65.)
-            n[] = noise();
+    // A flagged cost imbalance resets the schedule: repartitioning
+    // happens inside the wavelet adaptation, so the soonest rebalance
+    // is the next assessment
+    if (lb_rebalance_pending) {
+        adapt_every = 1;
+        lb_rebalance_pending = 0;
     }
 
-    // Adapt based on velocity, buoyancy, and noise
-    adapt_wavelet((scalar *){u, b, n},
-                  (double[]){eps, eps, .05 * 9.81 / 273, 0.001},
-                  maxlevel, minlevel);
+    // Mesh changes between consecutive steps are tiny; only run the
+    // wavelet assessment on the current schedule
+    if (i % adapt_every == 0) {
+        perf_begin("adapt");
+
+        // Add noise near canopy for better refinement (restricted to
+        // the canopy bounding box)
+        scalar n = scratch_checkout();
+        foreach() {
+            n[] = ADAPT_BOX(x, y) ? noise() : 0.;
+        }
+
+        // Adapt based on velocity, buoyancy, and noise
+        astats st = adapt_wavelet((scalar *){u, b, n},
+                                  (double[]){eps, eps, .05 * 9.81 / 273, 0.001},
+                                  maxlevel, minlevel);
+        scratch_release(n);
+
+        // Mesh changed: cached static geometries and region cell
+        // lists must be rebuilt
+        if (st.nf || st.nc) {
+            geom_invalidate(-1);
+            region_invalidate_all();
+        }
+
+        // Retune the interval from the fraction of cells this
+        // assessment actually changed (reduced globally so every rank
+        // keeps the same schedule)
+        double chg[2] = {st.nf + st.nc, grid->n};
+@if _MPI
+        MPI_Allreduce(MPI_IN_PLACE, chg, 2, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+@endif
+        double frac = chg[1] > 0. ? chg[0]/chg[1] : 0.;
+        if (frac > ADAPT_FRAC_HI)
+            adapt_every = max(1, adapt_every/2);
+        else if (frac < ADAPT_FRAC_LO && adapt_every < ADAPT_EVERY_MAX)
+            adapt_every++;
+
+        perf_end("adapt", grid->n);
+    }
 }
 
 // ============================================================
@@ -172,28 +284,56 @@ event slice_make(t += TEND)
     coord slice = {1., 1., 0};
     char names[300];
     snprintf(names, 300, "%sslice_%02g", W12dir, t);
-    FILE *fp = fopen(names, "w");
-    output_slice(list = (scalar *){b, u.x, u.y}, fp = fp,
-                 n = res, linear = true, plane = slice);
-    fclose(fp);
+    // Self-describing float32 slice, handed to the background writer;
+    // the solver continues immediately (async_fence() in the end event
+    // is the barrier)
+    output_slice_v2(list = (scalar *){b, u.x, u.y}, file = names,
+                    n = res, linear = true, plane = slice);
 }
 
 // ============================================================
 // EVENT: DUMP_FILE1 - Save complete simulation state for restart
 // ============================================================
-event dump_file1(t += TEND)
+event dump_file1(t += DUMP_DT)
 {
+    // Incremental checkpointing: the first call writes a stock full
+    // dump ("<name>.base", readable by plain restore()), later calls
+    // write deltas holding only the cells that drifted since the last
+    // checkpoint - so the interval must be short enough that successive
+    // checkpoints share most of their cells. The RESTORE_FILE path in
+    // init restores the base and replays the deltas in order.
     char name[80];
     sprintf(name, "dump-%03d", (int)t);
-    dump(file = name);
+    idump(file = name);
 }
 
 // ============================================================
 // EVENT: OUTPUT_B - Generate visualization videos every 1 second
 // ============================================================
 double mov_dt = 3.;
+#if !LIVE_MOVIES
+int frame_nr = 0;
+event output_b(t += mov_dt)
+{
+    perf_begin("output_b");
+
+    // Stage the fields the renderer needs as one compact float32
+    // snapshot; the writer thread handles the disk and
+    // render_frames.py turns the frame sequence into the mp4s, so the
+    // solver never blocks on OpenGL or encoding
+    char name[300];
+    snprintf(name, 300, "%sframe_%04d", framedir, frame_nr++);
+    coord slice = {1., 1., 0};
+    output_slice_v2(list = (scalar *){b, u.x, cw, CL, ROOF}, file = name,
+                    n = 256, linear = true, plane = slice);
+
+    perf_end("output_b", 0);
+}
+#else
 event output_b(t += mov_dt)
 {
+    perf_begin("output_b");
+
     view(width = 1200, height = 1200, tx = -0.5, ty = -0.5);
 
     // Video 1: Buoyancy field with canopy and roof
@@ -219,6 +359,18 @@ event output_b(t += mov_dt)
     draw_vof("ROOF", "fROOF", filled = 1, fc = {1, 1, 1});
     squares("cw", min = 0, max = 0.8, map = cool_warm, linear = true);
     save("cw.mp4");
+
+    perf_end("output_b", 0);
+}
+#endif
+
+// ============================================================
+// EVENT: PERF_LOG - Periodic machine-readable timing report
+// ============================================================
+event perf_log(i += 200)
+{
+    perf_report(stderr);
+    solver_mg_report(stderr);
 }
 
 // ============================================================
@@ -226,5 +378,12 @@ event output_b(t += mov_dt)
 // ============================================================
 event end(t = TEND)
 {
-    // Simulation complete
+    // End-of-run timing summary
+    perf_report(stderr);
+    solver_mg_report(stderr);
+
+    // Completion fence: all queued slice/dump writes must reach disk
+    // before the run terminates
+    async_fence();
+    async_shutdown();
 }
@@ -0,0 +1,356 @@
+/**
+ * Green3D.c - 3D Greenhouse simulation with canopy and wave-shaped roof
+ *
+ * Production configuration of the Green2D.c case: the same physics
+ * stack (SGS_TKE.h already carries the full 3D strain-rate tensor, the
+ * canopy and roof level sets are z-independent so they extrude
+ * naturally in the spanwise direction) on an octree with spanwise
+ * periodicity. Green2D.c remains the cheap calibration mode; this is
+ * the case file for the large MPI runs - see the strong-scaling notes
+ * in README.md.
+ */
+
+#include <sys/stat.h>
+#include "grid/octree.h"
+#include "navier-stokes/centered.h"
+#include "fractions.h"
+#include "output_slices.h"
+#include "incremental_dump.h"
+#include "fast_restore.h"
+
+// Simulation parameters
+int maxlevel, minlevel;              // Grid refinement levels
+double eps;                          // Adaptation criterion
+double TEND = 80.;                   // Simulation end time [s]
+#define DUMP_DT 10.                  // Checkpoint interval [s]
+
+#include "physics.h"
+#include "profiles.h"                // In-situ averaged vertical profiles
+#include "load_balance.h"            // Canopy-weighted rank-imbalance monitor
+
+// Output directory settings
+char filedir[200] = "./";
+char W12dir[230];
+char framedir[230];
+
+// ============================================================
+// GREENHOUSE ROOF PARAMETERS
+// ============================================================
+scalar ROOF[];                       // Roof volume fraction field (1 = inside roof, 0 = outside)
+face vector fROOF[];                 // Roof face fraction field
+#define NUM_WAVES 2                  // Number of waves across the domain
+#define ROOF_Y_MIN 70.               // Lowest point of the roof [m]
+#define ROOF_Y_MAX 100.              // Highest point of the roof [m]
+#define ROOF_Y_CENTER 85.            // Center height of roof [m]
+#define ROOF_AMPLITUDE 15.           // Wave amplitude [m]
+#define ROOF_WAVE_NUMBER (2.*M_PI*NUM_WAVES/L0)  // Wave number [rad/m]
+#define ROOF_VAL 0.5                 // Smoothing parameter for fractions
+
+// ============================================================
+// ADAPTATION SCHEDULER PARAMETERS
+// ============================================================
+// Bounding box for noise seeding: the canopy region, extruded over the
+// full spanwise extent (the cubes are z-independent)
+#define ADAPT_X_MIN 15.              // Left edge of noise box [m]
+#define ADAPT_X_MAX 85.              // Right edge of noise box [m]
+#define ADAPT_Y_MAX 35.              // Top of noise box, just above Zh [m]
+#define ADAPT_BOX(x, y) ((x) >= ADAPT_X_MIN && (x) <= ADAPT_X_MAX && \
+                         (y) <= ADAPT_Y_MAX)
+
+// Auto-tuned adaptation interval, as in Green2D.c. On an octree each
+// assessment touches 8x the cells of the 2D case, so letting the
+// interval grow in quiet phases matters even more here.
+int adapt_every = 1;                 // Current interval between adaptations
+#define ADAPT_EVERY_MAX 8            // Upper bound on the interval
+#define ADAPT_FRAC_HI 0.01           // Change fraction that halves the interval
+#define ADAPT_FRAC_LO 0.002          // Change fraction that grows the interval
+
+// Level set of the wavy roof (z-independent: the waves run spanwise)
+void roof_phi(vertex scalar phi)
+{
+    foreach_vertex() {
+        double y_roof = ROOF_Y_CENTER + ROOF_AMPLITUDE * cos(ROOF_WAVE_NUMBER * x);
+        phi[] = y - y_roof;
+    }
+}
+
+// ============================================================
+// MAIN FUNCTION - Set up simulation parameters
+// ============================================================
+int main()
+{
+  // Grid configuration: level 7 is a 128^3 effective resolution; raise
+  // maxlevel together with the rank count for the scaling runs
+  minlevel = 5;                      // Minimum refinement level
+  maxlevel = 7;                      // Maximum refinement level
+  N = 64;                            // Base grid size
+
+  // Domain configuration
+  L0 = 100;                          // Domain size [m]
+  X0 = Y0 = Z0 = 0;                  // Domain origin
+
+  // Physics configuration
+  a = av;                            // Acceleration field (buoyancy)
+  mu = Km;                           // Turbulent viscosity
+  Pr = unityf;                       // Prandtl number = 1
+  eps = .05;                         // Adaptation criterion
+
+  // Numerical methods
+  foreach_dimension()
+    u.x.refine = refine_linear;      // Momentum conserved during refinement
+  p.refine = p.prolongation = refine_linear;  // Pressure interpolation
+  b.gradient = minmod2;              // Flux limiter for buoyancy
+
+  // Boundary conditions
+  Boundary_C();                      // Set physics boundary conditions
+  leaf_BC();                         // Set canopy boundary conditions
+
+  // Spanwise direction: statistically homogeneous, so periodic
+  periodic(front);
+
+  // Second tangential velocity component at the walls (no-slip)
+  u.r[bottom] = dirichlet(0.);
+  u.r[top] = dirichlet(0.);
+
+  // Register the static roof with the geometry cache
+  geom_register(roof_phi, ROOF, fROOF);
+
+  run();
+}
+
+// ============================================================
+// HELPER FUNCTION - Create output directory
+// ============================================================
+void sim_dir_create(){
+    sprintf(W12dir, "%sW12/", filedir);
+    sprintf(framedir, "%sframes/", filedir);
+    if (pid() == 0)                  // Only master process creates directories
+    {
+        struct stat st = {0};
+        if (stat(W12dir, &st) == -1)
+            mkdir(W12dir, 0777);
+        if (stat(framedir, &st) == -1)
+            mkdir(framedir, 0777);
+    }
+}
+
+// ============================================================
+// EVENT: INIT - Initialize flow field and variables at t=0
+// ============================================================
+event init(t = 0)
+{
+    sim_dir_create();                // Create output directory
+
+#ifdef RESTORE_FILE
+    // Crash recovery: restart from a checkpoint base (compile with
+    // e.g. -DRESTORE_FILE='"dump-000.base"'), then roll forward
+    // through the incremental deltas written after it - the last delta
+    // found sets t to the newest checkpoint
+    if (fast_restore(file = RESTORE_FILE)) {
+        for (double td = DUMP_DT; td <= TEND; td += DUMP_DT) {
+            char dname[80];
+            sprintf(dname, "dump-%03d", (int)td);
+            if (idump_replay(dname, NULL) < 0)
+                break;               // No newer delta: restart point reached
+        }
+        geom_invalidate(-1);         // Cached fractions are not dumped
+        return 0;
+    }
+#endif
+
+    init_physics();                  // Initialize physical fields from physics.h
+
+    // Add noise for initial turbulence in the canopy region
+    scalar n = scratch_checkout();
+    foreach () {
+        n[] = ADAPT_BOX(x, y) ? noise() : 0.;
+    }
+
+    // Adapt grid based on initial conditions
+    while (adapt_wavelet((scalar *){u, b, n},
+           (double[]){eps, eps, eps, 0.35 * 9.81 / 273, 0.001},
+           maxlevel, minlevel).nf)
+    {
+        foreach () {
+            b[] = STRAT(y);          // Initialize buoyancy stratification
+            u.x[] = WIND(y);         // Initialize wind profile
+        }
+    }
+
+    scratch_release(n);
+
+    // Initialize canopy variables
+    foreach() {
+        TV[] = 295.15;               // Leaf temperature [K]
+        e120[] = Emin;               // TKE initialization
+    }
+}
+
+// ============================================================
+// EVENT: ROOF - Update cached roof fraction and damp velocity
+// ============================================================
+// Cached roof cell list: the roof is static, so between mesh changes
+// the damping only needs to visit the cells actually inside it
+static bool roof_cell(Point point)
+{
+    return ROOF[] > 0.5;             // More than 50% inside roof
+}
+Region * roof_region = NULL;
+
+event roof(i++)
+{
+    perf_begin("roof");
+
+    // Recompute the cached fractions only if adaptation touched the mesh
+    geom_cache_update();
+
+    // Damp velocity in roof region
+    if (roof_region == NULL)
+        roof_region = region_register(roof_cell);
+    region_update(roof_region);
+    for (int ic = 0; ic < roof_region->n; ic++) {
+        Point point = region_cell(roof_region, ic);
+        foreach_dimension()
+            u.x[] = 0.;
+    }
+
+    boundary({ROOF, u});
+
+    perf_end("roof", roof_region->n);
+}
+
+// ============================================================
+// EVENT: ADAPT - Adaptive mesh refinement
+// ============================================================
+event adapt(i++)
+{
+    // A flagged cost imbalance resets the schedule: repartitioning
+    // happens inside the wavelet adaptation, so the soonest rebalance
+    // is the next assessment
+    if (lb_rebalance_pending) {
+        adapt_every = 1;
+        lb_rebalance_pending = 0;
+    }
+
+    // Mesh changes between consecutive steps are tiny; only run the
+    // wavelet assessment on the current schedule
+    if (i % adapt_every == 0) {
+        perf_begin("adapt");
+
+        // Add noise near canopy for better refinement (restricted to
+        // the canopy bounding box)
+        scalar n = scratch_checkout();
+        foreach() {
+            n[] = ADAPT_BOX(x, y) ? noise() : 0.;
+        }
+
+        // Adapt based on velocity, buoyancy, and noise
+        astats st = adapt_wavelet((scalar *){u, b, n},
+                                  (double[]){eps, eps, eps, .05 * 9.81 / 273, 0.001},
+                                  maxlevel, minlevel);
+        scratch_release(n);
+
+        // Mesh changed: cached static geometries and region cell
+        // lists must be rebuilt
+        if (st.nf || st.nc) {
+            geom_invalidate(-1);
+            region_invalidate_all();
+        }
+
+        // Retune the interval from the fraction of cells this
+        // assessment actually changed (reduced globally so every rank
+        // keeps the same schedule)
+        double chg[2] = {st.nf + st.nc, grid->n};
+@if _MPI
+        MPI_Allreduce(MPI_IN_PLACE, chg, 2, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+@endif
+        double frac = chg[1] > 0. ? chg[0]/chg[1] : 0.;
+        if (frac > ADAPT_FRAC_HI)
+            adapt_every = max(1, adapt_every/2);
+        else if (frac < ADAPT_FRAC_LO && adapt_every < ADAPT_EVERY_MAX)
+            adapt_every++;
+
+        perf_end("adapt", grid->n);
+    }
+}
+
+// ============================================================
+// EVENT: SLICE_MAKE - Output 2D slice data at end time
+// ============================================================
+event slice_make(t += TEND)
+{
+    int res = 128;
+    char names[300];
+
+    // Vertical x-y slice at mid-span (the 3D analogue of the Green2D
+    // output; slice_traverse handles any axis-aligned plane)
+    coord vslice = {1., 1., 0.5};
+    snprintf(names, 300, "%sslice_%02g", W12dir, t);
+    output_slice_v2(list = (scalar *){b, u.x, u.y}, file = names,
+                    n = res, linear = true, plane = vslice);
+
+    // Horizontal x-z slice at canopy mid-height
+    coord hslice = {1., 0.15, 1.};
+    snprintf(names, 300, "%shslice_%02g", W12dir, t);
+    output_slice_v2(list = (scalar *){b, u.x, u.z}, file = names,
+                    n = res, linear = true, plane = hslice);
+}
+
+// ============================================================
+// EVENT: DUMP_FILE1 - Save complete simulation state for restart
+// ============================================================
+event dump_file1(t += DUMP_DT)
+{
+    // Incremental checkpointing, as in Green2D.c: full base first,
+    // value deltas every DUMP_DT afterwards; the RESTORE_FILE path in
+    // init restores the base and replays the deltas in order
+    char name[80];
+    sprintf(name, "dump-%03d", (int)t);
+    idump(file = name);
+}
+
+// ============================================================
+// EVENT: OUTPUT_B - Stage visualization frames
+// ============================================================
+// In 3D only the staged-frame pipeline makes sense (in-loop OpenGL
+// rendering does not scale to the production rank counts): mid-span
+// snapshots go to the background writer and render_frames.py turns
+// them into movies afterwards
+double mov_dt = 3.;
+int frame_nr = 0;
+event output_b(t += mov_dt)
+{
+    perf_begin("output_b");
+
+    char name[300];
+    snprintf(name, 300, "%sframe_%04d", framedir, frame_nr++);
+    coord slice = {1., 1., 0.5};
+    output_slice_v2(list = (scalar *){b, u.x, cw, CL, ROOF}, file = name,
+                    n = 256, linear = true, plane = slice);
+
+    perf_end("output_b", 0);
+}
+
+// ============================================================
+// EVENT: PERF_LOG - Periodic machine-readable timing report
+// ============================================================
+event perf_log(i += 200)
+{
+    perf_report(stderr);
+    solver_mg_report(stderr);
+}
+
+// ============================================================
+// EVENT: END - Simulation finished
+// ============================================================
+event end(t = TEND)
+{
+    // End-of-run timing summary
+    perf_report(stderr);
+    solver_mg_report(stderr);
+
+    // Completion fence: all queued slice/dump writes must reach disk
+    // before the run terminates
+    async_fence();
+    async_shutdown();
+}
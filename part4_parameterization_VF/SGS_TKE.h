@@ -11,7 +11,7 @@
  */
 
 #include "tracer.h"
-#include "diffusion.h"
+#include "diffusion_list.h"
 
 // ============================================================
 // SGS TURBULENCE PARAMETERS
@@ -38,6 +38,8 @@ scalar e12p[];                       // TKE source/sink term [m^2 s^-3]
 // ============================================================
 event Km_tke(i++)
 {
+  perf_begin("Km_tke");
+
   foreach ()
   {
     // ------------------------------------------------------------
@@ -61,9 +63,10 @@ event Km_tke(i++)
     }
     else {
       // Stable: mixing length limited by buoyancy
-      // λ = (κy^-1 + (Cn*e/√N²)^-1)^-1
+      // λ = (κy^-1 + (Cn*e/√N²)^-1)^-1, written with divisions instead
+      // of four pow() calls
       e120[] = (e120[] <= Emin) ? Emin : e120[];
-      lambda = pow(pow(kappa * y, -1) + pow(Cn * e120[] / sqrt(fabs(dbdz)), -1), -1);
+      lambda = 1./(1./(kappa * y) + sqrt(fabs(dbdz))/(Cn * e120[]));
     }
 
     // Eddy viscosity: Km = Cm * λ * √e
@@ -72,27 +75,50 @@ event Km_tke(i++)
     // ------------------------------------------------------------
     // STEP 2: Calculate strain rate tensor (S_ij * S_ij)
     // ------------------------------------------------------------
+    // Hot kernel, restructured so the compiler can vectorise it: the
+    // common 1/Delta factors are hoisted out of every term (a single
+    // multiply by 1/Delta^2 at the end replaces ~24 divisions), the
+    // stencil differences are plain add/multiply chains, and the
+    // z-stencils are compiled out of 2D builds so the 2D kernel only
+    // evaluates the x-y terms.
+    double idel2 = 1. / sq(Delta);
+
+#if dimension == 2
+    // Diagonal components (normal strain rates)
+    double tdef2 = 2. * (sq(u.x[1, 0] - u.x[]) +
+                         sq(u.y[0, 1] - u.y[]));
+
+    // Off-diagonal xy shear (four-corner average)
+    tdef2 += 0.25 * (sq((u.x[0, 1] - u.x[0, 0]) + (u.y[0, 1] - u.y[-1, 1])) +
+                     sq((u.x[0, 0] - u.x[0, -1]) + (u.y[0, 0] - u.y[-1, 0])) +
+                     sq((u.x[1, 0] - u.x[1, -1]) + (u.y[1, 0] - u.y[0, 0])) +
+                     sq((u.x[1, 1] - u.x[1, 0]) + (u.y[1, 1] - u.y[0, 1])));
+#else // dimension == 3
     // Diagonal components (normal strain rates)
-    double tdef2 = 2 / sq(Delta) * (sq(u.x[1, 0, 0] - u.x[]) +
-                                     sq(u.y[0, 1, 0] - u.y[]) +
-                                     sq(u.z[0, 0, 1] - u.z[]));
+    double tdef2 = 2. * (sq(u.x[1, 0, 0] - u.x[]) +
+                         sq(u.y[0, 1, 0] - u.y[]) +
+                         sq(u.z[0, 0, 1] - u.z[]));
 
     // Off-diagonal components (shear strain rates)
     // xy components
-    tdef2 += 0.25 * (sq((u.y[0, 0, 1] - u.y[-1, 0, 1]) / Delta + (u.x[0, 0, 1] - u.x[0, 0, 0]) / Delta) +
-                    sq((u.y[0, 0, 0] - u.y[-1, 0, 0]) / Delta + (u.x[0, 0, 0] - u.x[0, 0, -1]) / Delta) +
-                    sq((u.y[1, 0, 0] - u.y[0, 0, 0]) / Delta + (u.x[1, 0, 0] - u.x[1, 0, -1]) / Delta) +
-                    sq((u.y[1, 0, 1] - u.y[0, 0, 1]) / Delta + (u.x[1, 0, 1] - u.x[1, 0, 0]) / Delta));
+    tdef2 += 0.25 * (sq((u.y[0, 0, 1] - u.y[-1, 0, 1]) + (u.x[0, 0, 1] - u.x[0, 0, 0])) +
+                     sq((u.y[0, 0, 0] - u.y[-1, 0, 0]) + (u.x[0, 0, 0] - u.x[0, 0, -1])) +
+                     sq((u.y[1, 0, 0] - u.y[0, 0, 0]) + (u.x[1, 0, 0] - u.x[1, 0, -1])) +
+                     sq((u.y[1, 0, 1] - u.y[0, 0, 1]) + (u.x[1, 0, 1] - u.x[1, 0, 0])));
     // xz components
-    tdef2 += 0.25 * (sq((u.x[0, 1, 0] - u.x[0, 0, 0]) / Delta + (u.z[0, 1, 0] - u.z[-1, 1, 0]) / Delta) +
-                    sq((u.x[0, 0, 0] - u.x[0, -1, 0]) / Delta + (u.z[0, 0, 0] - u.z[-1, 0, 0]) / Delta) +
-                    sq((u.x[1, 0, 0] - u.x[1, -1, 0]) / Delta + (u.z[1, 0, 0] - u.z[0, 0, 0]) / Delta) +
-                    sq((u.x[1, 1, 0] - u.x[1, 0, 0]) / Delta + (u.z[1, 1, 0] - u.z[0, 1, 0]) / Delta));
+    tdef2 += 0.25 * (sq((u.x[0, 1, 0] - u.x[0, 0, 0]) + (u.z[0, 1, 0] - u.z[-1, 1, 0])) +
+                     sq((u.x[0, 0, 0] - u.x[0, -1, 0]) + (u.z[0, 0, 0] - u.z[-1, 0, 0])) +
+                     sq((u.x[1, 0, 0] - u.x[1, -1, 0]) + (u.z[1, 0, 0] - u.z[0, 0, 0])) +
+                     sq((u.x[1, 1, 0] - u.x[1, 0, 0]) + (u.z[1, 1, 0] - u.z[0, 1, 0])));
     // yz components
-    tdef2 += 0.25 * (sq((u.z[0, 0, 1] - u.z[0, 0, 0]) / Delta + (u.y[0, 0, 1] - u.y[0, -1, 1]) / Delta) +
-                    sq((u.z[0, 0, 0] - u.z[0, 0, -1]) / Delta + (u.y[0, 0, 0] - u.y[0, -1, 0]) / Delta) +
-                    sq((u.z[0, 1, 0] - u.z[0, 1, -1]) / Delta + (u.y[0, 1, 0] - u.y[0, 0, 0]) / Delta) +
-                    sq((u.z[0, 1, 1] - u.z[0, 1, 0]) / Delta + (u.y[0, 1, 1] - u.y[0, 0, 1]) / Delta));
+    tdef2 += 0.25 * (sq((u.z[0, 0, 1] - u.z[0, 0, 0]) + (u.y[0, 0, 1] - u.y[0, -1, 1])) +
+                     sq((u.z[0, 0, 0] - u.z[0, 0, -1]) + (u.y[0, 0, 0] - u.y[0, -1, 0])) +
+                     sq((u.z[0, 1, 0] - u.z[0, 1, -1]) + (u.y[0, 1, 0] - u.y[0, 0, 0])) +
+                     sq((u.z[0, 1, 1] - u.z[0, 1, 0]) + (u.y[0, 1, 1] - u.y[0, 0, 1])));
+#endif
+
+    // Single deferred scaling by 1/Delta^2
+    tdef2 *= idel2;
 
     // ------------------------------------------------------------
     // STEP 3: Calculate TKE source/sink terms
@@ -107,7 +133,7 @@ event Km_tke(i++)
 
     // Canopy drag sink (wake production of turbulence)
     #if CANOPY
-    e12p[] = e12p[] - 4. / 3. * Cd * PAD(y) * U[] * e120[] * CL[];
+    e12p[] = e12p[] - 4. / 3. * CDPAD_AT(y) * U[] * e120[] * CL[];
     #endif
   }
 
@@ -123,6 +149,8 @@ event Km_tke(i++)
   }
 
   boundary({Km, Kh, Ke});
+
+  perf_end("Km_tke", grid->n);
 }
 
 // ============================================================
@@ -133,5 +161,9 @@ mgstats mgb;                             // Multigrid solver statistics
 event tracer_diffusion(i++)
 {
   // Solve TKE evolution: ∂e/∂t + u·∇e = ∇·(Ke∇e) + P + B - ε - Dc
-  mgb = diffusion(e120, dt, Ke, r = e12p);
+  // (same backward-Euler discretisation as diffusion(); the list solver
+  // adds the warm start and cycle accounting from solver_control.h)
+  perf_begin("tke_diffusion");
+  mgb = diffusion_list((scalar *){e120}, dt, Ke, rl = (scalar *){e12p});
+  perf_end("tke_diffusion", grid->n);
 }
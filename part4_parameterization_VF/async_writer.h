@@ -0,0 +1,121 @@
+/**
+ * async_writer.h - Background writer thread for solver output
+ *
+ * Slice and dump events used to block the timestep loop while rank 0
+ * streamed data to (possibly network) filesystems. This header provides
+ * a small writer stage: output buffers are handed over to a dedicated
+ * pthread which performs the file writes while the solver continues
+ * immediately. Buffers are queued, so consecutive outputs double-buffer
+ * naturally; async_fence() is the completion barrier to call before the
+ * run ends (or before a file must be visible on disk).
+ *
+ * Only rank 0 (which does all slice writing) ever enqueues jobs, so the
+ * writer needs no MPI awareness.
+ */
+
+#include <pthread.h>
+
+typedef struct AsyncJob {
+    char * path;                     // Destination file name
+    char * data;                     // Payload (ownership transferred)
+    size_t len;                      // Payload size [bytes]
+    struct AsyncJob * next;
+} AsyncJob;
+
+static pthread_t async_thread;
+static pthread_mutex_t async_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t async_wake = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t async_done = PTHREAD_COND_INITIALIZER;
+static AsyncJob * async_head = NULL, * async_tail = NULL;
+static int async_pending = 0;        // Queued + in-flight jobs
+static bool async_started = false, async_quit = false;
+
+// ============================================================
+// Writer thread: dequeue jobs and write each buffer in one go
+// ============================================================
+static void * async_writer_main(void * unused)
+{
+    for (;;) {
+        pthread_mutex_lock(&async_lock);
+        while (!async_head && !async_quit)
+            pthread_cond_wait(&async_wake, &async_lock);
+        AsyncJob * job = async_head;
+        if (job) {
+            async_head = job->next;
+            if (!async_head)
+                async_tail = NULL;
+        }
+        pthread_mutex_unlock(&async_lock);
+
+        if (!job)
+            return NULL;             // Quit requested and queue drained
+
+        FILE * fp = fopen(job->path, "w");
+        if (fp) {
+            fwrite(job->data, 1, job->len, fp);
+            fclose(fp);
+        }
+        else
+            fprintf(stderr, "async_writer: could not open '%s'\n", job->path);
+        free(job->data);
+        free(job->path);
+        free(job);
+
+        pthread_mutex_lock(&async_lock);
+        if (--async_pending == 0)
+            pthread_cond_broadcast(&async_done);
+        pthread_mutex_unlock(&async_lock);
+    }
+}
+
+// ============================================================
+// FUNCTION: async_write - Queue a buffer for background writing
+// ============================================================
+// Takes ownership of data (must be malloc'd); returns immediately.
+void async_write(const char * path, char * data, size_t len)
+{
+    AsyncJob * job = (AsyncJob *) malloc(sizeof(AsyncJob));
+    job->path = strdup(path);
+    job->data = data;
+    job->len = len;
+    job->next = NULL;
+
+    pthread_mutex_lock(&async_lock);
+    if (!async_started) {
+        pthread_create(&async_thread, NULL, async_writer_main, NULL);
+        async_started = true;
+    }
+    if (async_tail)
+        async_tail->next = job;
+    else
+        async_head = job;
+    async_tail = job;
+    async_pending++;
+    pthread_cond_signal(&async_wake);
+    pthread_mutex_unlock(&async_lock);
+}
+
+// ============================================================
+// FUNCTION: async_fence - Wait until all queued writes hit disk
+// ============================================================
+void async_fence()
+{
+    pthread_mutex_lock(&async_lock);
+    while (async_pending > 0)
+        pthread_cond_wait(&async_done, &async_lock);
+    pthread_mutex_unlock(&async_lock);
+}
+
+// Drain the queue and stop the writer thread (called at end of run)
+void async_shutdown()
+{
+    if (!async_started)
+        return;
+    pthread_mutex_lock(&async_lock);
+    async_quit = true;
+    pthread_cond_signal(&async_wake);
+    pthread_mutex_unlock(&async_lock);
+    pthread_join(async_thread, NULL);
+    async_started = false;
+    async_quit = false;
+}
@@ -0,0 +1,61 @@
+/**
+ * fast_restore.h - Memory-mapped restarts from dump files
+ *
+ * Restarting from a large dump goes through buffered stdio: every rank
+ * re-reads the whole file through read() into private buffers, and
+ * nothing is shared between the rapid successive restarts of a
+ * crash-recovery workflow. fast_restore() maps the checkpoint with
+ * mmap() instead and feeds the mapping to the stock restore() through
+ * fmemopen(): reads become zero-copy page faults, the kernel prefetches
+ * sequentially (madvise), and all ranks of a node - and consecutive
+ * restarts - share one copy of the file in page cache, so only the
+ * first restart after a crash pays for the disk.
+ *
+ * Truly lazy per-rank faulting (touching only the local partition's
+ * pages) would need an index section in the dump format itself, which
+ * is owned upstream; with the sequential format every rank still
+ * parses the full stream, but from shared, already-warm pages.
+ */
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+
+struct sFastRestore {
+    char * file;
+    scalar * list;
+};
+
+trace bool fast_restore (struct sFastRestore p)
+{
+    int fd = open (p.file, O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat (fd, &st) < 0 || st.st_size == 0) {
+        close (fd);
+        return false;
+    }
+
+    char * map = (char *) mmap (NULL, st.st_size, PROT_READ, MAP_PRIVATE,
+                                fd, 0);
+    close (fd);                      // The mapping keeps the file alive
+    if (map == MAP_FAILED)
+        return false;
+
+    // The restore pass is a single forward sweep
+    madvise (map, st.st_size, MADV_SEQUENTIAL);
+
+    FILE * fp = fmemopen (map, st.st_size, "r");
+    if (!fp) {
+        munmap (map, st.st_size);
+        return false;
+    }
+
+    bool ok = p.list ? restore (fp = fp, list = p.list) : restore (fp = fp);
+
+    fclose (fp);
+    munmap (map, st.st_size);
+    return ok;
+}
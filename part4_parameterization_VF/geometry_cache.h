@@ -0,0 +1,85 @@
+/**
+ * geometry_cache.h - Cached volume/face fractions for static geometries
+ *
+ * The roof and the canopy cubes never move, yet their volume and face
+ * fractions were rebuilt with fractions() at every iteration. The only
+ * reason the fractions can change is a mesh change, so this header keeps
+ * a small registry of static geometries and recomputes a geometry only
+ * when it has been invalidated (typically after adapt_wavelet has
+ * refined or coarsened cells).
+ *
+ * Usage:
+ *   - register each geometry once (e.g. in main()) with geom_register(),
+ *     passing a function that fills the vertex level set;
+ *   - call geom_cache_update() at the top of the events that use the
+ *     fractions: it is a no-op while the cache is clean;
+ *   - call geom_invalidate() after any mesh change (the adapt events do
+ *     this when adapt_wavelet reports refined/coarsened cells).
+ */
+
+#include "fractions.h"
+
+// Function filling the vertex level set of a registered geometry
+typedef void (*geom_levelset) (vertex scalar phi);
+
+typedef struct {
+    geom_levelset phi_fn;            // Level-set generator
+    scalar c;                        // Volume fraction field
+    face vector f;                   // Face fraction field
+    bool dirty;                      // Needs recomputation
+} GeomCache;
+
+#define GEOM_CACHE_MAX 8             // Static obstacles we can track
+GeomCache geom_cache[GEOM_CACHE_MAX];
+int geom_cache_n = 0;
+
+// Level-set workspace shared by all rebuilds (allocating a vertex
+// scalar per rebuild would churn the allocator for nothing)
+vertex scalar geom_phi[];
+
+// ============================================================
+// FUNCTION: geom_register - Register a static geometry
+// ============================================================
+// The fractions are computed lazily by the first geom_cache_update()
+// call, so registration is cheap and can happen before run().
+int geom_register (geom_levelset phi_fn, scalar c, face vector f)
+{
+    assert (geom_cache_n < GEOM_CACHE_MAX);
+    GeomCache * g = &geom_cache[geom_cache_n];
+    g->phi_fn = phi_fn;
+    g->c = c;
+    g->f = f;
+    g->dirty = true;
+    return geom_cache_n++;
+}
+
+// ============================================================
+// FUNCTION: geom_invalidate - Mark geometries for recomputation
+// ============================================================
+// id >= 0 invalidates a single geometry, id < 0 invalidates all of
+// them (the common case after adaptation, which can touch any cell).
+void geom_invalidate (int id)
+{
+    for (int g = 0; g < geom_cache_n; g++)
+        if (id < 0 || id == g)
+            geom_cache[g].dirty = true;
+}
+
+// ============================================================
+// FUNCTION: geom_cache_update - Recompute dirty geometries
+// ============================================================
+void geom_cache_update()
+{
+    for (int id = 0; id < geom_cache_n; id++) {
+        GeomCache * g = &geom_cache[id];
+        if (!g->dirty)
+            continue;                // Cache hit: nothing to do
+
+        g->phi_fn (geom_phi);        // Rebuild the level set
+        scalar c = g->c;
+        face vector f = g->f;
+        fractions (geom_phi, c, f);  // Recompute volume/face fractions
+        boundary ({c});
+        g->dirty = false;
+    }
+}
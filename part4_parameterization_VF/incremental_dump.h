@@ -0,0 +1,233 @@
+/**
+ * incremental_dump.h - Incremental checkpoints on top of dump/restore
+ *
+ * A full dump() writes every field of every cell at each checkpoint,
+ * so checkpoint cost scales with domain size even when almost nothing
+ * changed since the last one. idump() writes a stock full dump once
+ * (the base, readable by plain restore()), keeps shadow copies of the
+ * tracked fields, and afterwards writes delta files holding only the
+ * leaf cells whose values drifted past a threshold: one record of
+ * (x, y, level, values) per changed cell. Checkpoint cost then scales
+ * with mesh churn, not domain size. Every IDUMP_REBASE checkpoints a
+ * fresh base is written so a restart never replays more than a few
+ * deltas.
+ *
+ * Restart: restore() the latest base, then idump_replay() each newer
+ * delta in order (pass NULL to replay the same default field list the
+ * deltas were written with). Each delta carries its simulation time, so
+ * a successful replay also advances t to the checkpoint it reproduces.
+ *
+ * Limitations (deliberate, this is checkpointing for a tutorial code,
+ * not a parallel I/O library): deltas carry values, not tree
+ * structure, so on replay each record is injected into the leaf cell
+ * containing its coordinates - if the mesh has been refined between
+ * base and delta the value lands on the coarser base cell. The
+ * periodic rebase bounds the resulting error. Delta records are
+ * gathered to rank 0, which hands the packed file to the background
+ * writer.
+ */
+
+#include "async_writer.h"
+
+// Checkpoints between full rebases
+#define IDUMP_REBASE 10
+// Absolute + relative value drift that marks a cell as changed
+#define IDUMP_TOL 1e-6
+
+scalar * idump_list = NULL;          // Tracked fields (fixed at first call)
+scalar * idump_shadow = NULL;        // Copies at the last checkpoint
+int idump_count = 0;                 // Checkpoints since the last base
+
+// Growable record buffer: each record is (2 + 1 + len) doubles,
+// [x, y, level, v0 ... v_len-1] (level stored as a double for layout
+// simplicity)
+typedef struct {
+    double * r;
+    long n, max;                     // Doubles used / allocated
+} IDumpBuf;
+
+static void idump_buf_push (IDumpBuf * b, double v)
+{
+    if (b->n == b->max) {
+        b->max = b->max ? 2*b->max : 4096;
+        b->r = (double *) realloc (b->r, b->max*sizeof(double));
+    }
+    b->r[b->n++] = v;
+}
+
+// ============================================================
+// FUNCTION: idump - Write a base or delta checkpoint
+// ============================================================
+// file is the checkpoint name: the base goes to "<file>.base", deltas
+// to "<file>" itself (give each delta a distinct name, e.g. with the
+// timestep in it). list defaults to all dumpable fields, like dump().
+struct sIDump {
+    char * file;
+    scalar * list;
+};
+
+// Fix the tracked list at the first call (mirrors dump(): all fields
+// not flagged nodump). Shared with idump_replay() so a restart resolves
+// the same default list the deltas were written with.
+static void idump_fix_list (scalar * list)
+{
+    if (idump_list)
+        return;
+    if (list)
+        idump_list = list_copy (list);
+    else
+        for (scalar s in all)
+            if (!s.nodump)
+                idump_list = list_append (idump_list, s);
+}
+
+trace void idump (struct sIDump p)
+{
+    idump_fix_list (p.list);
+    int len = list_len (idump_list);
+
+    // Full base checkpoint: stock dump() plus a shadow refresh
+    if (!idump_shadow || idump_count >= IDUMP_REBASE) {
+        char base[300];
+        snprintf (base, 300, "%s.base", p.file);
+        dump (file = base, list = idump_list);
+
+        if (!idump_shadow)
+            for (scalar s in idump_list) {
+                scalar c = new scalar;
+                c.nodump = true;
+                idump_shadow = list_append (idump_shadow, c);
+            }
+        foreach() {
+            scalar s, c;
+            for (s, c in idump_list, idump_shadow)
+                c[] = s[];
+        }
+        idump_count = 0;
+        return;
+    }
+
+    // Delta checkpoint: collect leaf cells whose tracked values
+    // drifted past IDUMP_TOL since the last checkpoint
+    IDumpBuf buf = {NULL, 0, 0};
+    foreach(serial) {
+        bool changed = false;
+        scalar s, c;
+        for (s, c in idump_list, idump_shadow)
+            if (fabs(s[] - c[]) > IDUMP_TOL*max(1., fabs(s[])))
+                changed = true;
+        if (changed) {
+            idump_buf_push (&buf, x);
+            idump_buf_push (&buf, y);
+            idump_buf_push (&buf, level);
+            for (s, c in idump_list, idump_shadow) {
+                idump_buf_push (&buf, s[]);
+                c[] = s[];           // Shadow tracks what was written
+            }
+        }
+    }
+
+@if _MPI
+    // Gather the per-rank record buffers on rank 0 (same pattern as
+    // the slice gather in output_slices.h)
+    int count = buf.n*sizeof(double);
+    int * counts = NULL, * displs = NULL;
+    char * recv = NULL;
+    long total = 0;
+    if (pid() == 0)
+        counts = (int *) malloc (npe()*sizeof(int));
+    MPI_Gather (&count, 1, MPI_INT, counts, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    if (pid() == 0) {
+        displs = (int *) malloc (npe()*sizeof(int));
+        for (int r = 0; r < npe(); r++) {
+            displs[r] = total;
+            total += counts[r];
+        }
+        recv = (char *) malloc (total > 0 ? total : 1);
+    }
+    MPI_Gatherv (buf.r, count, MPI_BYTE, recv, counts, displs, MPI_BYTE,
+                 0, MPI_COMM_WORLD);
+    free (buf.r);
+    if (pid() == 0) {
+        free (counts);
+        free (displs);
+        buf.r = (double *) recv;
+        buf.n = total/sizeof(double);
+    }
+    else
+        buf.r = NULL, buf.n = 0;
+@endif
+
+    if (pid() == 0) {
+        // Pack header + records into one buffer for the writer thread
+        // (the header carries the checkpoint time so a replay can
+        // advance t to the state it reproduces)
+        long nrec = buf.n/(3 + len);
+        size_t hsize = 8 + sizeof(int) + sizeof(long) + sizeof(double);
+        size_t size = hsize + buf.n*sizeof(double);
+        char * out = (char *) malloc (size);
+        memcpy (out, "IDELTA2\0", 8);
+        memcpy (out + 8, &len, sizeof(int));
+        memcpy (out + 8 + sizeof(int), &nrec, sizeof(long));
+        memcpy (out + 8 + sizeof(int) + sizeof(long), &t, sizeof(double));
+        memcpy (out + hsize, buf.r, buf.n*sizeof(double));
+        async_write (p.file, out, size);
+    }
+    free (buf.r);
+    idump_count++;
+}
+
+// ============================================================
+// FUNCTION: idump_replay - Apply one delta after restore()
+// ============================================================
+// Call restore() on the base first, then replay each newer delta in
+// order. Returns the number of records applied, or -1 on error (no
+// such file, wrong format, list mismatch). list may be NULL, meaning
+// the same default list idump() tracks; a successful replay sets t to
+// the checkpoint time stored in the delta.
+int idump_replay (const char * file, scalar * list)
+{
+    if (!list) {
+        idump_fix_list (NULL);
+        list = idump_list;
+    }
+
+    FILE * fp = fopen (file, "r");
+    if (!fp)
+        return -1;
+
+    char magic[8];
+    int len;
+    long nrec;
+    double trec;
+    if (fread (magic, 1, 8, fp) != 8 || strncmp (magic, "IDELTA2", 7) ||
+        fread (&len, sizeof(int), 1, fp) != 1 ||
+        fread (&nrec, sizeof(long), 1, fp) != 1 ||
+        fread (&trec, sizeof(double), 1, fp) != 1 ||
+        len != list_len (list)) {
+        fclose (fp);
+        return -1;
+    }
+
+    int applied = 0;
+    double * rec = (double *) malloc ((3 + len)*sizeof(double));
+    for (long q = 0; q < nrec; q++) {
+        if (fread (rec, sizeof(double), 3 + len, fp) != (size_t)(3 + len))
+            break;
+        // Inject into the leaf cell owning these coordinates (may be
+        // coarser than the recorded level, see header comment)
+        Point point = locate (rec[0], rec[1]);
+        if (point.level >= 0) {
+            int k = 3;
+            for (scalar s in list)
+                s[] = rec[k++];
+            applied++;
+        }
+    }
+    free (rec);
+    fclose (fp);
+
+    boundary (list);
+    t = trec;                        // Resume from the checkpoint time
+    return applied;
+}
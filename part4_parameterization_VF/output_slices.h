@@ -1,6 +1,8 @@
 /**
 Here I copy the slice output function to Vslice function -> when output the vslice, we can choose only the 80m below
 */
+#include "async_writer.h"
+
 double THE_ang = M_PI * 55. / 180.;
 
 struct sOutputSlice
@@ -12,6 +14,210 @@ struct sOutputSlice
     coord plane;
 };
 
+/**
+ * Batched sampling backend
+ *
+ * The original slice functions called interpolate()/locate() once per
+ * sample point and per scalar - each an independent O(log N) tree
+ * search. slice_traverse() walks the local tree once: every leaf cell
+ * computes the range of slice-lattice indices it contains and evaluates
+ * all scalars of the list for those points, so the whole n x n x len
+ * slice is filled in a single traversal per rank.
+ */
+
+// Cell-local (bi/tri)linear interpolation, equivalent to interpolate()
+// once the containing cell is known
+static inline double slice_linear(Point point, scalar s,
+                                  double xp, double yp, double zp)
+{
+    double dx = (xp - x)/Delta, dy = (yp - y)/Delta;
+#if dimension == 2
+    int i = sign(dx), j = sign(dy);
+    dx = fabs(dx); dy = fabs(dy);
+    return (s[]*(1. - dx)*(1. - dy) + s[i]*dx*(1. - dy) +
+            s[0,j]*(1. - dx)*dy + s[i,j]*dx*dy);
+#else
+    double dz = (zp - z)/Delta;
+    int i = sign(dx), j = sign(dy), k = sign(dz);
+    dx = fabs(dx); dy = fabs(dy); dz = fabs(dz);
+    return (((s[]*(1. - dx) + s[i]*dx)*(1. - dy) +
+             (s[0,j]*(1. - dx) + s[i,j]*dx)*dy)*(1. - dz) +
+            ((s[0,0,k]*(1. - dx) + s[i,0,k]*dx)*(1. - dy) +
+             (s[0,j,k]*(1. - dx) + s[i,j,k]*dx)*dy)*dz);
+#endif
+}
+
+// One sample of the slice lattice: linear index into the row-major
+// n x n x len matrix, plus its value. Used by the owner-computes
+// gather so ranks only communicate the points they actually own.
+typedef struct {
+    long index;
+    double value;
+} SlicePacket;
+
+typedef void (*slice_emit)(long index, double value, void * data);
+
+// Walk the local tree once (spacing Ds, plane as in output_slice()) and
+// emit every owned sample of the n x n slice lattice.
+trace void slice_traverse(scalar * list, int n, double Ds, coord plane,
+                          bool linear, slice_emit emit, void * edata)
+{
+    int len = list_len(list);
+
+    // Decode the output_slice() coordinate mapping: which axis varies
+    // with the i index, which with j, and which (if any) is fixed
+    bool varX = !(plane.x < 1.);
+    int ax_i, ax_j, ax_f = -1;       // Axes: 0 = x, 1 = y, 2 = z
+    double fixed = 0.;
+    double orig[3] = {X0, Y0, Z0};
+    if (varX) {
+        ax_i = 0;
+        if (plane.y < 1.) {          // Horizontal slice: y fixed, j -> z
+            ax_f = 1;
+            fixed = plane.y*L0 + Y0;
+            ax_j = 2;
+        }
+        else {                       // Vertical slice: j -> y, z fixed
+            ax_j = 1;
+            if (plane.z < 1.) {
+                ax_f = 2;
+                fixed = plane.z*L0 + Z0;
+            }
+        }
+    }
+    else {                           // x fixed: i -> y, j -> z
+        ax_f = 0;
+        fixed = plane.x*L0 + X0;
+        ax_i = 1;
+        ax_j = 2;
+    }
+
+    foreach(serial) {
+        double cc[3] = {x, y, z};
+
+        // Only cells cut by the slice plane contribute (half-open
+        // ownership so each lattice point is sampled by exactly one cell)
+#if dimension == 2
+        bool cut = (ax_f < 0 || ax_f == 2) ? true :
+#else
+        bool cut = (ax_f < 0) ? true :
+#endif
+            (fixed >= cc[ax_f] - Delta/2. && fixed < cc[ax_f] + Delta/2.);
+
+        if (cut) {
+            // Lattice index ranges covered by this cell in both directions
+            int i0 = max(0, (int) ceil((cc[ax_i] - Delta/2. - orig[ax_i])/Ds));
+            int i1 = min(n - 1, (int) floor((cc[ax_i] + Delta/2. - orig[ax_i])/Ds - 1e-12));
+            int j0 = max(0, (int) ceil((cc[ax_j] - Delta/2. - orig[ax_j])/Ds));
+            int j1 = min(n - 1, (int) floor((cc[ax_j] + Delta/2. - orig[ax_j])/Ds - 1e-12));
+#if dimension == 2
+            if (ax_j == 2)           // No z direction: fill all columns
+                j0 = 0, j1 = n - 1;
+#endif
+
+            for (int ii = i0; ii <= i1; ii++)
+                for (int jj = j0; jj <= j1; jj++) {
+                    double sp[3] = {0., 0., 0.};
+                    sp[ax_i] = Ds*ii + orig[ax_i];
+                    sp[ax_j] = Ds*jj + orig[ax_j];
+                    if (ax_f >= 0)
+                        sp[ax_f] = fixed;
+                    long base = (long) ii*n*len + (long) len*jj;
+                    int k = 0;
+                    for (scalar s in list)
+                        emit(base + k++, linear ?
+                             slice_linear(point, s, sp[0], sp[1], sp[2]) : s[],
+                             edata);
+                }
+        }
+    }
+}
+
+// Emit helper filling the slice matrix directly (rank 0)
+static void slice_emit_matrix(long index, double value, void * data)
+{
+    ((double *) data)[index] = value;
+}
+
+@ if _MPI
+// Emit helper appending to a growable packet buffer (other ranks)
+typedef struct {
+    SlicePacket * p;
+    long n, max;
+} SlicePacketBuf;
+
+static void slice_emit_packet(long index, double value, void * data)
+{
+    SlicePacketBuf * b = (SlicePacketBuf *) data;
+    if (b->n == b->max) {
+        b->max = b->max ? 2*b->max : 1024;
+        b->p = (SlicePacket *) realloc(b->p, b->max*sizeof(SlicePacket));
+    }
+    b->p[b->n].index = index;
+    b->p[b->n++].value = value;
+}
+@endif
+
+// Owner-computes assembly of the slice: every rank samples only the
+// lattice points inside its own subdomain; rank 0 fills its part of the
+// matrix directly while the other ranks send compact (index, value)
+// packets which rank 0 scatters into place. Memory on non-root ranks
+// and communication volume are proportional to the owned points, not
+// to the full n x n x len matrix. Returns the assembled matrix on
+// rank 0 and NULL elsewhere.
+double ** slice_gather(scalar * list, int n, double Ds, coord plane,
+                       bool linear)
+{
+    int len = list_len(list);
+    double ** field = NULL;
+
+    if (pid() == 0) {
+        field = (double **) matrix_new(n, n, len*sizeof(double));
+        for (long q = 0; q < (long) n*n*len; q++)
+            field[0][q] = nodata;
+        slice_traverse(list, n, Ds, plane, linear, slice_emit_matrix,
+                       field[0]);
+    }
+
+    @ if _MPI
+    SlicePacketBuf buf = {NULL, 0, 0};
+    if (pid() != 0)
+        slice_traverse(list, n, Ds, plane, linear, slice_emit_packet, &buf);
+
+    // Gather per-rank packet sizes, then the packets themselves
+    int count = buf.n*sizeof(SlicePacket);
+    int * counts = NULL, * displs = NULL;
+    char * recv = NULL;
+    long total = 0;
+    if (pid() == 0)
+        counts = (int *) malloc(npe()*sizeof(int));
+    MPI_Gather(&count, 1, MPI_INT, counts, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    if (pid() == 0) {
+        displs = (int *) malloc(npe()*sizeof(int));
+        for (int r = 0; r < npe(); r++) {
+            displs[r] = total;
+            total += counts[r];
+        }
+        recv = (char *) malloc(total > 0 ? total : 1);
+    }
+    MPI_Gatherv(buf.p, count, MPI_BYTE, recv, counts, displs, MPI_BYTE,
+                0, MPI_COMM_WORLD);
+
+    if (pid() == 0) {
+        // Scatter the received packets into the output matrix
+        SlicePacket * pk = (SlicePacket *) recv;
+        for (long q = 0; q < total/(long) sizeof(SlicePacket); q++)
+            field[0][pk[q].index] = pk[q].value;
+        free(recv);
+        free(displs);
+        free(counts);
+    }
+    free(buf.p);
+    @endif
+
+    return field;
+}
+
 trace void output_slice(struct sOutputSlice p)
 {
     if (!p.list)
@@ -29,127 +235,217 @@ trace void output_slice(struct sOutputSlice p)
     p.n++;
 
     int len = list_len(p.list);
-    double **field = (double **)matrix_new(p.n, p.n, len * sizeof(double));
     double Delta = 0.999999 * L0 / (p.n - 1);
 
-    // the loop of resolution grid
-    // find the cartesion grid coordinate
-    for (int i = 0; i < p.n; i++)
-    {
-        double varCoord1 = Delta * i; // some clever way of implementing general variation of coordinates instead of mapping them directly to x, y or z
-        bool varX = !(p.plane.x < 1.);
-        double x = (!varX ? p.plane.x * L0 : varCoord1) + X0;
-
-        for (int j = 0; j < p.n; j++)
-        {
-            double varCoord2 = Delta * j;
-            double y = (varX ? (p.plane.y < 1. ? p.plane.y * L0 : varCoord2) : varCoord1) + Y0;
-            double z = (p.plane.z < 1. ? p.plane.z * L0 : varCoord2) + Z0;
-            if (p.linear)
-            {
-                int k = 0;
-                for (scalar s in p.list)
-                    field[i][len * j + k++] = interpolate(s, x, y, z);
-            }
-            else
-            {
-                Point point = locate(x, y, z);
-                int k = 0;
-                for (scalar s in p.list)
-                    field[i][len * j + k++] = point.level >= 0 ? s[] : nodata;
-            }
-        }
-    }
+    // single-traversal sampling with owner-computes gather: only rank 0
+    // holds the full matrix, other ranks send their owned points
+    double **field = slice_gather(p.list, p.n, Delta, p.plane, p.linear);
 
     if (pid() == 0)
     { // master
-        @ if _MPI
-            MPI_Reduce(MPI_IN_PLACE, field[0], len * p.n * p.n, MPI_DOUBLE, MPI_MIN, 0,
-                       MPI_COMM_WORLD);
-        @endif
-
             // fprintf (p.fp, "x=%g\ty=%g\tz=%g\tn=%d\tlen=%d\n", p.plane.x*L0, p.plane.y*L0, p.plane.z*L0, p.n, len);
             int k = 0;
+        double *row = (double *)malloc(p.n * sizeof(double));
         for (scalar s in p.list)
         {
             // fprintf (p.fp, "%s\n", s.name);
             for (int i = 0; i < p.n; i++)
             {
+                // de-interleave the row, then one bulk write per field row
                 for (int j = 0; j < p.n; j++)
-                {
-                    //   fprintf(p.fp, "%g\t", (float)field[i][len * j + k]);
-                    fwrite(&field[i][len * j + k], sizeof(double), 1, p.fp);
-                }
-                // fputc('\n', p.fp);
+                    row[j] = field[i][len * j + k];
+                fwrite(row, sizeof(double), p.n, p.fp);
             }
             k++;
         }
+        free(row);
         fflush(p.fp);
+        matrix_free(field);
     }
-    @ if _MPI 
-    else // slave
-        MPI_Reduce(field[0], NULL, len * p.n * p.n, MPI_DOUBLE, MPI_MIN, 0,
-                   MPI_COMM_WORLD);
-    @endif
-    matrix_free(field);
 }
 
-trace void output_Vslice(struct sOutputSlice p)
+/**
+ * Asynchronous slice output: same binary layout as output_slice(), but
+ * the slice is assembled into one contiguous buffer on rank 0 and
+ * handed to the background writer thread (async_writer.h), so the
+ * solver never blocks on the filesystem. Call async_fence() before
+ * the run ends.
+ */
+struct sOutputSliceAsync
+{
+    scalar *list;
+    char *file;
+    int n;
+    bool linear;
+    coord plane;
+};
+
+trace void output_slice_async(struct sOutputSliceAsync p)
 {
     if (!p.list)
         p.list = all;
     if (p.n == 0)
         p.n = N;
-    if (!p.fp)
-        p.fp = stdout;
     if (!p.plane.x)
         p.plane.x = 1.;
     if (!p.plane.y)
-        p.plane.y = 1.;
+        p.plane.y = 0.;
     if (!p.plane.z)
-        p.plane.z = 0.;
+        p.plane.z = 1.;
     p.n++;
 
     int len = list_len(p.list);
-    double **field = (double **)matrix_new(p.n, p.n, len * sizeof(double));
     double Delta = 0.999999 * L0 / (p.n - 1);
 
-    // the loop of resolution grid
-    // find the cartesion grid coordinate
-    for (int i = 0; i < p.n; i++)
-    {
-        double varCoord1 = Delta * i; // some clever way of implementing general variation of coordinates instead of mapping them directly to x, y or z
-        bool varX = !(p.plane.x < 1.);
-        double x = (!varX ? p.plane.x * L0 : varCoord1) + X0;
+    double **field = slice_gather(p.list, p.n, Delta, p.plane, p.linear);
 
-        for (int j = 0; j < p.n; j++)
+    if (pid() == 0)
+    { // master: pack the whole payload, enqueue, return immediately
+        size_t size = (size_t)len * p.n * p.n * sizeof(double);
+        double *buf = (double *)malloc(size);
+        size_t q = 0;
+        int k = 0;
+        for (scalar s in p.list)
         {
-            double varCoord2 = Delta * j;
-            double y = (varX ? (p.plane.y < 1. ? p.plane.y * L0 : varCoord2) : varCoord1) + Y0;
-            double z = (p.plane.z < 1. ? p.plane.z * L0 : varCoord2) + Z0;
-            if (p.linear)
+            for (int i = 0; i < p.n; i++)
+                for (int j = 0; j < p.n; j++)
+                    buf[q++] = field[i][len * j + k];
+            k++;
+        }
+        async_write(p.file, (char *)buf, size);
+        matrix_free(field);
+    }
+}
+
+/**
+ * v2 slice format: self-describing and float32
+ *
+ * The raw-double v1 stream forces every reader to hard-code n and the
+ * field list, and weighs 8 bytes per sample. v2 writes
+ *
+ *   char   magic[8]   "BSLICE2\0"
+ *   int32  n, len
+ *   double t, plane[3]
+ *   len x  { char name[16]; double offset, scale; }
+ *   len x n x n float32, field-major, value = offset + scale*stored
+ *
+ * Each field is normalised to [0,1] by its own offset/scale before the
+ * float32 cast, so the 24-bit mantissa covers the field range rather
+ * than its absolute magnitude (a leaf-temperature field around 295 K
+ * keeps sub-mK resolution). nodata samples are stored as NaN. The
+ * whole file is assembled in one buffer and handed to the background
+ * writer, so the write is a single sequential stream. Chunked
+ * zstd/lz4 compression would halve it again but would add the first
+ * external dependency of this code; the float32+scaling step alone
+ * already halves v1.
+ */
+struct sOutputSliceV2
+{
+    scalar *list;
+    char *file;
+    int n;
+    bool linear;
+    coord plane;
+};
+
+trace void output_slice_v2(struct sOutputSliceV2 p)
+{
+    if (!p.list)
+        p.list = all;
+    if (p.n == 0)
+        p.n = N;
+    if (!p.plane.x)
+        p.plane.x = 1.;
+    if (!p.plane.y)
+        p.plane.y = 0.;
+    if (!p.plane.z)
+        p.plane.z = 1.;
+    p.n++;
+
+    int len = list_len(p.list);
+    double Ds = 0.999999 * L0 / (p.n - 1);
+
+    double **field = slice_gather(p.list, p.n, Ds, p.plane, p.linear);
+
+    if (pid() == 0)
+    { // master: pack header + descriptors + float32 payload, enqueue
+        long npts = (long)p.n * p.n;
+        size_t hsize = 8 + 2 * sizeof(int) + 4 * sizeof(double) +
+                       len * (16 + 2 * sizeof(double));
+        size_t size = hsize + (size_t)len * npts * sizeof(float);
+        char *buf = (char *)malloc(size);
+
+        char *hq = buf;
+        memcpy(hq, "BSLICE2\0", 8), hq += 8;
+        memcpy(hq, &p.n, sizeof(int)), hq += sizeof(int);
+        memcpy(hq, &len, sizeof(int)), hq += sizeof(int);
+        memcpy(hq, &t, sizeof(double)), hq += sizeof(double);
+        double plane[3] = {p.plane.x, p.plane.y, p.plane.z};
+        memcpy(hq, plane, 3 * sizeof(double)), hq += 3 * sizeof(double);
+
+        float *pq = (float *)(buf + hsize);
+        int k = 0;
+        for (scalar s in p.list)
+        {
+            // Per-field range for the normalisation (nodata excluded)
+            double fmin = HUGE, fmax = -HUGE;
+            for (long q = 0; q < npts; q++)
             {
-                int k = 0;
-                for (scalar s in p.list)
-                    field[i][len * j + k++] = interpolate(s, x, y, z);
+                double v = field[0][len * q + k];
+                if (v != nodata)
+                {
+                    if (v < fmin) fmin = v;
+                    if (v > fmax) fmax = v;
+                }
             }
-            else
+            double offset = fmin <= fmax ? fmin : 0.;
+            double scale = fmax > fmin ? fmax - fmin : 1.;
+
+            // Field descriptor
+            char name[16] = {0};
+            strncpy(name, s.name, 15);
+            memcpy(hq, name, 16), hq += 16;
+            memcpy(hq, &offset, sizeof(double)), hq += sizeof(double);
+            memcpy(hq, &scale, sizeof(double)), hq += sizeof(double);
+
+            // Normalised float32 payload (de-interleaved, field-major)
+            for (long q = 0; q < npts; q++)
             {
-                Point point = locate(x, y, z);
-                int k = 0;
-                for (scalar s in p.list)
-                    field[i][len * j + k++] = point.level >= 0 ? s[] : nodata;
+                double v = field[0][len * q + k];
+                *pq++ = v != nodata ? (float)((v - offset) / scale) : NAN;
             }
+            k++;
         }
+        async_write(p.file, buf, size);
+        matrix_free(field);
     }
+}
+
+trace void output_Vslice(struct sOutputSlice p)
+{
+    if (!p.list)
+        p.list = all;
+    if (p.n == 0)
+        p.n = N;
+    if (!p.fp)
+        p.fp = stdout;
+    if (!p.plane.x)
+        p.plane.x = 1.;
+    if (!p.plane.y)
+        p.plane.y = 1.;
+    if (!p.plane.z)
+        p.plane.z = 0.;
+    p.n++;
+
+    int len = list_len(p.list);
+    double Delta = 0.999999 * L0 / (p.n - 1);
+
+    // single-traversal sampling with owner-computes gather: only rank 0
+    // holds the full matrix, other ranks send their owned points
+    double **field = slice_gather(p.list, p.n, Delta, p.plane, p.linear);
 
     if (pid() == 0)
     { // master
-        @ if _MPI
-            MPI_Reduce(MPI_IN_PLACE, field[0], len * p.n * p.n, MPI_DOUBLE, MPI_MIN, 0,
-                       MPI_COMM_WORLD);
-        @endif
-
             // fprintf (p.fp, "x=%g\ty=%g\tz=%g\tn=%d\tlen=%d\n", p.plane.x*L0, p.plane.y*L0, p.plane.z*L0, p.n, len);
             int k = 0;
         for (scalar s in p.list)
@@ -167,13 +463,8 @@ trace void output_Vslice(struct sOutputSlice p)
             k++;
         }
         fflush(p.fp);
+        matrix_free(field);
     }
-    @ if _MPI 
-    else // slave
-        MPI_Reduce(field[0], NULL, len * p.n * p.n, MPI_DOUBLE, MPI_MIN, 0,
-                   MPI_COMM_WORLD);
-    @endif
-    matrix_free(field);
 }
 
 trace 
@@ -194,45 +485,14 @@ void output_Vyslice(struct sOutputSlice p)
     p.n++;
 
     int len = list_len(p.list);
-    double **field = (double **)matrix_new(p.n, p.n, len * sizeof(double));
     double Delta = 0.999999 * L0 / (p.n - 1);
 
-    // the loop of resolution grid
-    // find the cartesion grid coordinate
-    for (int i = 0; i < p.n; i++)
-    {
-        double varCoord1 = Delta * i; // some clever way of implementing general variation of coordinates instead of mapping them directly to x, y or z
-        bool varX = !(p.plane.x < 1.);
-        double x = (!varX ? p.plane.x * L0 : varCoord1) + X0;
-
-        for (int j = 0; j < p.n; j++)
-        {
-            double varCoord2 = Delta * j;
-            double y = (varX ? (p.plane.y < 1. ? p.plane.y * L0 : varCoord2) : varCoord1) + Y0;
-            double z = (p.plane.z < 1. ? p.plane.z * L0 : varCoord2) + Z0;
-            if (p.linear)
-            {
-                int k = 0;
-                for (scalar s in p.list)
-                    field[i][len * j + k++] = interpolate(s, x, y, z);
-            }
-            else
-            {
-                Point point = locate(x, y, z);
-                int k = 0;
-                for (scalar s in p.list)
-                    field[i][len * j + k++] = point.level >= 0 ? s[] : nodata;
-            }
-        }
-    }
+    // single-traversal sampling with owner-computes gather: only rank 0
+    // holds the full matrix, other ranks send their owned points
+    double **field = slice_gather(p.list, p.n, Delta, p.plane, p.linear);
 
     if (pid() == 0)
     { // master
-        @ if _MPI
-            MPI_Reduce(MPI_IN_PLACE, field[0], len * p.n * p.n, MPI_DOUBLE, MPI_MIN, 0,
-                       MPI_COMM_WORLD);
-        @endif
-
             // fprintf (p.fp, "x=%g\ty=%g\tz=%g\tn=%d\tlen=%d\n", p.plane.x*L0, p.plane.y*L0, p.plane.z*L0, p.n, len);
             int k = 0;
         for (scalar s in p.list)
@@ -250,13 +510,8 @@ void output_Vyslice(struct sOutputSlice p)
             k++;
         }
         fflush(p.fp);
+        matrix_free(field);
     }
-    @ if _MPI 
-    else // slave
-        MPI_Reduce(field[0], NULL, len * p.n * p.n, MPI_DOUBLE, MPI_MIN, 0,
-                   MPI_COMM_WORLD);
-    @endif
-    matrix_free(field);
 }
 
 
@@ -277,45 +532,14 @@ trace void output_Vslice_TV(struct sOutputSlice p)
     p.n++;
 
     int len = list_len(p.list);
-    double **field = (double **)matrix_new(p.n, p.n, len * sizeof(double));
     double Delta = 0.999999 * L0 / (p.n - 1);
 
-    // the loop of resolution grid
-    // find the cartesion grid coordinate
-    for (int i = 0; i < p.n; i++)
-    {
-        double varCoord1 = Delta * i; // some clever way of implementing general variation of coordinates instead of mapping them directly to x, y or z
-        bool varX = !(p.plane.x < 1.);
-        double x = (!varX ? p.plane.x * L0 : varCoord1) + X0;
-
-        for (int j = 0; j < p.n; j++)
-        {
-            double varCoord2 = Delta * j;
-            double y = (varX ? (p.plane.y < 1. ? p.plane.y * L0 : varCoord2) : varCoord1) + Y0;
-            double z = (p.plane.z < 1. ? p.plane.z * L0 : varCoord2) + Z0;
-            if (p.linear)
-            {
-                int k = 0;
-                for (scalar s in p.list)
-                    field[i][len * j + k++] = interpolate(s, x, y, z);
-            }
-            else
-            {
-                Point point = locate(x, y, z);
-                int k = 0;
-                for (scalar s in p.list)
-                    field[i][len * j + k++] = point.level >= 0 ? s[] : nodata;
-            }
-        }
-    }
+    // single-traversal sampling with owner-computes gather: only rank 0
+    // holds the full matrix, other ranks send their owned points
+    double **field = slice_gather(p.list, p.n, Delta, p.plane, p.linear);
 
     if (pid() == 0)
     { // master
-        @ if _MPI
-            MPI_Reduce(MPI_IN_PLACE, field[0], len * p.n * p.n, MPI_DOUBLE, MPI_MIN, 0,
-                       MPI_COMM_WORLD);
-        @endif
-
             // fprintf (p.fp, "x=%g\ty=%g\tz=%g\tn=%d\tlen=%d\n", p.plane.x*L0, p.plane.y*L0, p.plane.z*L0, p.n, len);
             int k = 0;
         for (scalar s in p.list)
@@ -333,13 +557,8 @@ trace void output_Vslice_TV(struct sOutputSlice p)
             k++;
         }
         fflush(p.fp);
+        matrix_free(field);
     }
-    @ if _MPI 
-    else // slave
-        MPI_Reduce(field[0], NULL, len * p.n * p.n, MPI_DOUBLE, MPI_MIN, 0,
-                   MPI_COMM_WORLD);
-    @endif
-    matrix_free(field);
 }
 
 trace void output_W12(struct sOutputSlice p)
@@ -0,0 +1,101 @@
+/**
+ * perf_events.h - Per-event hot-path timing instrumentation
+ *
+ * There was no way to see where a timestep goes: roof, leaf_flow,
+ * Km_tke, acceleration, tracer_diffusion and adapt all run per
+ * iteration with zero timing. This header provides named timing
+ * sections recording wall time, call count and cells touched, with
+ * min/max across MPI ranks so rank imbalance is visible under the
+ * -D_MPI=1 build. perf_report() emits one machine-readable line per
+ * section ("perf: ...") - call it periodically and once at the end of
+ * the run for the summary.
+ */
+
+#include <sys/time.h>
+
+typedef struct {
+    const char * name;               // Section name
+    double time;                     // Accumulated wall time [s]
+    long calls;                      // Number of begin/end pairs
+    long cells;                      // Accumulated cells touched
+    double t0;                       // Start time of the open section
+} PerfEvent;
+
+#define PERF_MAX 32
+PerfEvent perf_events[PERF_MAX];
+int perf_events_n = 0;
+
+// Wall clock (MPI_Wtime under MPI for cross-rank consistency)
+static double perf_now()
+{
+@if _MPI
+    return MPI_Wtime();
+@else
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec*1e-6;
+@endif
+}
+
+// Find or create the section with this name
+static PerfEvent * perf_get(const char * name)
+{
+    for (int e = 0; e < perf_events_n; e++)
+        if (!strcmp(perf_events[e].name, name))
+            return &perf_events[e];
+    assert (perf_events_n < PERF_MAX);
+    PerfEvent * e = &perf_events[perf_events_n++];
+    e->name = name;
+    e->time = 0., e->calls = 0, e->cells = 0;
+    return e;
+}
+
+// ============================================================
+// FUNCTION: perf_begin / perf_end - Bracket a timed section
+// ============================================================
+void perf_begin(const char * name)
+{
+    perf_get(name)->t0 = perf_now();
+}
+
+// cells is the number of cells the section touched (pass grid->n for
+// full-domain traversals, 0 if not meaningful)
+void perf_end(const char * name, long cells)
+{
+    PerfEvent * e = perf_get(name);
+    e->time += perf_now() - e->t0;
+    e->calls++;
+    e->cells += cells;
+}
+
+// ============================================================
+// FUNCTION: perf_report - Machine-readable per-section report
+// ============================================================
+// One line per section:
+//   perf: i=<iter> t=<time> name=<s> calls=<n> time=<s> cells=<n>
+//         mcells_s=<rate> tmin=<s> tmax=<s> imb=<max/min>
+// Under MPI the time min/max are across ranks and cells/rates are
+// summed; the report is printed by rank 0 only.
+void perf_report(FILE * fp)
+{
+    for (int e = 0; e < perf_events_n; e++) {
+        double tloc = perf_events[e].time;
+        double tmin = tloc, tmax = tloc, tsum = tloc;
+        long cells = perf_events[e].cells;
+@if _MPI
+        MPI_Allreduce(MPI_IN_PLACE, &tmin, 1, MPI_DOUBLE, MPI_MIN, MPI_COMM_WORLD);
+        MPI_Allreduce(MPI_IN_PLACE, &tmax, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+        MPI_Allreduce(MPI_IN_PLACE, &tsum, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+        MPI_Allreduce(MPI_IN_PLACE, &cells, 1, MPI_LONG, MPI_SUM, MPI_COMM_WORLD);
+@endif
+        if (pid() == 0)
+            fprintf(fp, "perf: i=%d t=%g name=%s calls=%ld time=%.6f "
+                    "cells=%ld mcells_s=%.3f tmin=%.6f tmax=%.6f imb=%.2f\n",
+                    i, t, perf_events[e].name, perf_events[e].calls,
+                    tsum/npe(), cells,
+                    tsum > 0. ? cells/tsum/1e6 : 0.,
+                    tmin, tmax, tmin > 0. ? tmax/tmin : 0.);
+    }
+    if (pid() == 0)
+        fflush(fp);
+}
@@ -41,11 +41,23 @@ scalar *tracers = {b, e120, cw};     // List of advected tracers
 // ============================================================
 // CANOPY AND TURBULENCE MODELS
 // ============================================================
+#include "perf_events.h"             // Per-event timing instrumentation
+#include "scratch.h"                 // Scratch-field arena for temporaries
+
 #define CANOPY 1                     // Enable canopy model (1=on, 0=off)
 #if CANOPY
 #include "Canopy.h"
 #endif
 
+// Implicit canopy drag (1=point-implicit sink at the end of the step,
+// 0=explicit face forcing). The explicit form caps the stable timestep
+// at the drag relaxation time 1/(Cd*PAD*|U|) inside the canopy; the
+// implicit form is unconditionally stable so dt stays advection-limited.
+#ifndef IMPLICIT_DRAG
+#define IMPLICIT_DRAG 1
+#endif
+
+#include "diffusion_list.h"          // Batched multi-scalar diffusion solve
 #include "SGS_TKE.h"                 // Sub-grid scale turbulence model
 
 // ============================================================
@@ -103,6 +115,8 @@ void init_physics(){
 // ============================================================
 event acceleration(i++)
 {
+    perf_begin("acceleration");
+
     // ------------------------------------------------------------
     // STEP 1: Buoyancy forcing (gravity)
     // ------------------------------------------------------------
@@ -115,24 +129,61 @@ event acceleration(i++)
     // STEP 2: Canopy drag (momentum sink)
     // ------------------------------------------------------------
     #if CANOPY
-    // Calculate velocity magnitude at cell centers
+    // Calculate velocity magnitude at cell centers; it is only consumed
+    // multiplied by CL (drag and TKE wake production), so skip the sqrt
+    // outside the canopy
     foreach () {
-        U[] = sqrt(sq(u.x[]) + sq(u.y[]));
+#if dimension == 3
+        U[] = CL[] > 0. ? sqrt(sq(u.x[]) + sq(u.y[]) + sq(u.z[])) : 0.;
+#else
+        U[] = CL[] > 0. ? sqrt(sq(u.x[]) + sq(u.y[])) : 0.;
+#endif
     }
 
+    #if !IMPLICIT_DRAG
     // Apply drag force to horizontal faces
     // Drag = -Cd * PAD * |U| * u * CL
     foreach_face() {
-        // Interpolate velocity magnitude and velocity to face
-        double U_face = (U[] + U[-1])/2.;
-        double u_face = (u.x[] + u.x[-1])/2.;
         double CL_face = (CL[] + CL[-1])/2.;
-
-        // Add drag acceleration (negative = opposing flow)
-        av.x[] = av.x[] - Cd * PAD(y) * U_face * u_face * CL_face;
+        if (CL_face > 0.) {
+            // Interpolate velocity magnitude and velocity to face
+            double U_face = (U[] + U[-1])/2.;
+            double u_face = (u.x[] + u.x[-1])/2.;
+
+            // Add drag acceleration (negative = opposing flow)
+            av.x[] = av.x[] - CDPAD_AT(y) * U_face * u_face * CL_face;
+        }
     }
     #endif
+    #endif
+
+    perf_end("acceleration", grid->n);
+}
+
+#if CANOPY && IMPLICIT_DRAG
+// ============================================================
+// EVENT: end_timestep - Point-implicit canopy drag
+// ============================================================
+// Patankar linearization of du/dt = -Cd*PAD*|U|*u*CL with |U| frozen
+// at the old step: u_new = u/(1 + dt*Cd*PAD*|U|*CL). The sink can only
+// relax u towards zero, never overshoot, for any dt
+event end_timestep(i++)
+{
+    perf_begin("drag_implicit");
+
+    foreach() {
+        if (CL[] > 0.) {
+            double fdrag = 1./(1. + dt * CDPAD_AT(y) * U[] * CL[]);
+            foreach_dimension()
+                u.x[] *= fdrag;
+        }
+    }
+
+    boundary((scalar *){u});
+
+    perf_end("drag_implicit", grid->n);
 }
+#endif
 
 // ============================================================
 // EVENT: tracer_diffusion - Solve diffusion with source terms from canopy
@@ -141,8 +192,12 @@ mgstats mgb;                         // Multigrid solver statistics
 
 event tracer_diffusion(i++)
 {
-    scalar r[];                      // Source term for buoyancy [m s^-3]
-    scalar r_cw[];                   // Source term for water vapor [kg kg^-1 s^-1]
+    perf_begin("tracer_diffusion");
+
+    // Source terms for buoyancy [m s^-3] and water vapor [kg kg^-1 s^-1],
+    // borrowed from the scratch arena (fully overwritten below)
+    scalar r = scratch_checkout();
+    scalar r_cw = scratch_checkout();
 
     foreach() {
         r[] = 0;
@@ -151,11 +206,11 @@ event tracer_diffusion(i++)
         #if CANOPY
         // Source from sensible heat flux (converts to buoyancy)
         // H [W m^-2] -> [K m s^-1] -> [m s^-3] (buoyancy units)
-        r[] = r[] + H[] / (Cp_a * rho_a) * (gCONST / TREF) * PAD(y) * CL[];
+        r[] = r[] + H[] / (Cp_a * rho_a) * (gCONST / TREF) * PAD_AT(y) * CL[];
 
         // Source from transpiration (converts to concentration change)
         // QE [kg m^-2 s^-1] -> [kg kg^-1 s^-1] (concentration units)
-        r_cw[] = r_cw[] + QE[] * PAD(y) * CL[];
+        r_cw[] = r_cw[] + QE[] * PAD_AT(y) * CL[];
         #endif
     }
 
@@ -170,7 +225,13 @@ event tracer_diffusion(i++)
     // flx = flx/sq(L0);
     // fprintf(stderr, "soil=%g %g %g %d\n", t, fctr*flx, bt * TREF / gCONST, i);
 
-    // Solve diffusion equation with source terms
-    mgb = diffusion(b, dt, Kh, r = r);      // Buoyancy diffusion
-    diffusion(cw, dt, Kh, r = r_cw);        // Water vapor diffusion
+    // Solve both diffusion equations in one batched multigrid solve:
+    // b and cw share the identical operator (same Kh, same dt)
+    mgb = diffusion_list((scalar *){b, cw}, dt, Kh,
+                         rl = (scalar *){r, r_cw});
+
+    scratch_release(r);
+    scratch_release(r_cw);
+
+    perf_end("tracer_diffusion", grid->n);
 }
@@ -10,11 +10,34 @@ plt.rc('xtick', labelsize='20')
 plt.rc('ytick', labelsize='20')
 plt.rc('text', usetex=True)
 # %% # --------------------------------------------------------- #
-grid = 129
+def read_slice_v2(fname):
+    """Read a self-describing v2 slice (output_slice_v2 in output_slices.h).
+
+    Returns (names, t, data) with data of shape (len, n, n) in physical
+    units (the per-field offset/scale of the float32 storage is undone).
+    """
+    with open(fname, 'rb') as f:
+        magic = f.read(8)
+        assert magic.startswith(b'BSLICE2'), "not a v2 slice file"
+        n, nf = np.fromfile(f, np.int32, 2)
+        t, px, py, pz = np.fromfile(f, np.float64, 4)
+        names, offsets, scales = [], [], []
+        for k in range(nf):
+            names.append(f.read(16).split(b'\0')[0].decode())
+            o, s = np.fromfile(f, np.float64, 2)
+            offsets.append(o)
+            scales.append(s)
+        data = np.fromfile(f, np.float32, nf * n * n)
+    data = data.reshape(nf, n, n).astype(float)
+    for k in range(nf):
+        data[k] = offsets[k] + scales[k] * data[k]
+    return names, t, data
+
 file_dir = os.path.dirname(os.path.realpath(__file__))
 case_dir = file_dir + "/W12"
 Slice_files = case_dir + "/slice_50"
-Slice = np.fromfile(Slice_files, dtype = float).reshape(3, grid, grid)
+names, t_slice, Slice = read_slice_v2(Slice_files)
+grid = Slice.shape[1]            # no longer hard-coded: read from the header
 #%% determine the circle area - create x, y index
 xi = np.linspace(0, 100, grid)
 yi = np.linspace(0, 100, grid)
@@ -0,0 +1,106 @@
+/**
+ * profiles.h - In-situ horizontally averaged vertical profiles
+ *
+ * Mean profiles used to be computed offline by averaging
+ * high-frequency slice archives, so the slice output frequency was
+ * dictated by statistics, not by visualization. This header
+ * accumulates the statistics during the run instead: every step each
+ * cell adds its area-weighted contribution to a fixed set of vertical
+ * bins - first moments of u, v, b, cw, TKE and the canopy H and QE
+ * budgets, plus the second moments needed for the u'b', u'w' and w'b'
+ * covariances. At every flush interval the bins are reduced across
+ * ranks, written as one small text file (KB, not GB) and reset, so
+ * each file holds the space-time average over its window.
+ *
+ * Covariances are formed at flush time as E[ab] - E[a]E[b] over the
+ * combined horizontal/time sample of the window.
+ */
+
+#define PROF_NBINS 128               // Vertical bins across the domain
+#define PROF_EVERY 1                 // Accumulate every PROF_EVERY steps
+#define PROF_FLUSH_DT 10.            // Window length / file interval [s]
+
+// Per-bin accumulators: area weight, then area-weighted sums of
+// u, v, b, cw, e12, H, QE, u*b, u*v, v*b
+#define PROF_NV 11
+static double prof_acc[PROF_NBINS][PROF_NV];
+static long prof_samples = 0;        // Steps accumulated in this window
+
+// ============================================================
+// EVENT: profiles_accum - Accumulate the current step into the bins
+// ============================================================
+event profiles_accum(i += PROF_EVERY)
+{
+    perf_begin("profiles");
+
+    foreach(serial) {
+        int bin = (int)((y - Y0)/L0*PROF_NBINS);
+        if (bin >= 0 && bin < PROF_NBINS) {
+            // Cell-size weight (adaptive mesh): area in 2D, volume on
+            // the Green3D octree - sq(Delta) there would over-weight
+            // the fine canopy cells by a factor 2^(maxlevel - level)
+#if dimension == 3
+            double w = cube(Delta);
+#else
+            double w = sq(Delta);
+#endif
+            double * a = prof_acc[bin];
+            a[0] += w;
+            a[1] += w*u.x[];
+            a[2] += w*u.y[];
+            a[3] += w*b[];
+            a[4] += w*cw[];
+            a[5] += w*e120[];
+            a[6] += w*H[];           // Zero outside the canopy
+            a[7] += w*QE[];
+            a[8] += w*u.x[]*b[];
+            a[9] += w*u.x[]*u.y[];
+            a[10] += w*u.y[]*b[];
+        }
+    }
+    prof_samples++;
+
+    perf_end("profiles", grid->n);
+}
+
+// ============================================================
+// EVENT: profiles_flush - Reduce, write and reset the window
+// ============================================================
+event profiles_flush(t += PROF_FLUSH_DT)
+{
+    if (prof_samples) {
+@if _MPI
+        if (pid() == 0)
+            MPI_Reduce(MPI_IN_PLACE, prof_acc, PROF_NBINS*PROF_NV,
+                       MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+        else
+            MPI_Reduce(prof_acc, NULL, PROF_NBINS*PROF_NV,
+                       MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+@endif
+        if (pid() == 0) {
+            char name[120];
+            sprintf(name, "prof_%05d", (int)t);
+            FILE * fp = fopen(name, "w");
+            fprintf(fp, "# t=%g samples=%ld\n", t, prof_samples);
+            fprintf(fp, "# y u v b cw e12 H QE ub uw wb\n");
+            for (int bin = 0; bin < PROF_NBINS; bin++) {
+                double * a = prof_acc[bin];
+                double W = a[0];
+                if (W > 0.) {
+                    double mu = a[1]/W, mv = a[2]/W, mb = a[3]/W;
+                    fprintf(fp, "%g %g %g %g %g %g %g %g %g %g %g\n",
+                            Y0 + (bin + 0.5)*L0/PROF_NBINS,
+                            mu, mv, mb, a[4]/W, a[5]/W, a[6]/W, a[7]/W,
+                            a[8]/W - mu*mb,      // u'b'
+                            a[9]/W - mu*mv,      // u'w'
+                            a[10]/W - mv*mb);    // w'b'
+                }
+            }
+            fclose(fp);
+        }
+
+        // Start the next window on every rank
+        memset(prof_acc, 0, sizeof(prof_acc));
+        prof_samples = 0;
+    }
+}
@@ -0,0 +1,90 @@
+/**
+ * region_index.h - Cached cell lists for region-restricted events
+ *
+ * Several per-step events do full-domain traversals for work that is
+ * only meaningful in a small subregion: the canopy energy balance
+ * touches every cell to update fields that are zero outside CL[] > 0,
+ * and the roof damping scans everything to zero velocity inside the
+ * roof. This header caches, per registered region, the list of locally
+ * owned cells satisfying a predicate; the list is rebuilt lazily after
+ * the mesh has changed (same invalidation contract as part3's
+ * interface_index.h), so region events iterate O(region) instead of
+ * O(domain).
+ *
+ * The list holds the cell handles themselves, captured during the
+ * rebuild traversal - the same caching probes.h uses for probe points.
+ * A handle stays valid exactly as long as the mesh is unchanged, which
+ * is the lifetime of the list, so iterating it is a direct stencil
+ * access per member cell with no per-step tree search.
+ *
+ * Usage:
+ *   - register a region once with region_register(pred), where pred is
+ *     a function of Point (it may read fields, e.g. CL[] > 0.);
+ *   - call region_invalidate_all() when adapt_wavelet changes the mesh
+ *     (the adapt events do this, next to geom_invalidate());
+ *   - call region_update() before reading the list; region_dirty()
+ *     tells the caller a rebuild is about to happen, in case stale
+ *     values outside the fresh list need clearing;
+ *   - iterate the n entries; region_cell() yields the Point.
+ */
+
+typedef bool (*RegionPred)(Point point);
+
+typedef struct {
+    RegionPred pred;                 // Membership predicate
+    Point * cells;                   // Locally owned member cells
+    int n;                           // Number of indexed cells
+    int max;                         // Allocated capacity
+    bool dirty;                      // Needs rebuilding
+} Region;
+
+#define REGION_MAX 4
+static Region regions[REGION_MAX];
+static int region_n = 0;
+
+// Register a region (done once, lazily, by the event that uses it)
+Region * region_register(RegionPred pred)
+{
+    assert (region_n < REGION_MAX);
+    Region * r = &regions[region_n++];
+    r->pred = pred;
+    r->cells = NULL;
+    r->n = r->max = 0;
+    r->dirty = true;
+    return r;
+}
+
+// Mark every region stale (cheap; called after mesh changes)
+void region_invalidate_all()
+{
+    for (int q = 0; q < region_n; q++)
+        regions[q].dirty = true;
+}
+
+// True if the next region_update() will rebuild the list
+bool region_dirty(Region * r)
+{
+    return r->dirty;
+}
+
+// Rebuild the cell list if the mesh changed since the last call,
+// capturing the handle of each member cell
+void region_update(Region * r)
+{
+    if (!r->dirty)
+        return;
+
+    r->n = 0;
+    foreach(serial)
+        if (r->pred(point)) {
+            if (r->n == r->max) {
+                r->max = r->max ? 2*r->max : 256;
+                r->cells = (Point *) realloc (r->cells, r->max*sizeof(Point));
+            }
+            r->cells[r->n++] = point;
+        }
+    r->dirty = false;
+}
+
+// Point of the ic-th entry (valid until the next invalidation)
+#define region_cell(r, ic) ((r)->cells[ic])
@@ -0,0 +1,77 @@
+# %%
+# Post-hoc renderer for the staged movie frames written by Green2D.c
+# (LIVE_MOVIES=0 path): each frame is a v2 slice snapshot of
+# {b, u.x, cw, CL, ROOF}. Renders one PNG per frame and field into
+# frames/png/, then the mp4s are a single ffmpeg call, e.g.
+#   ffmpeg -framerate 10 -i frames/png/b_%04d.png b.mp4
+# None of this runs inside the solver loop.
+import numpy as np
+import glob
+import os
+import matplotlib
+matplotlib.use('Agg')
+import matplotlib.pyplot as plt
+
+# %%
+def read_slice_v2(fname):
+    """Read a self-describing v2 slice (output_slice_v2 in output_slices.h)."""
+    with open(fname, 'rb') as f:
+        magic = f.read(8)
+        assert magic.startswith(b'BSLICE2'), "not a v2 slice file"
+        n, nf = np.fromfile(f, np.int32, 2)
+        t, px, py, pz = np.fromfile(f, np.float64, 4)
+        names, offsets, scales = [], [], []
+        for k in range(nf):
+            names.append(f.read(16).split(b'\0')[0].decode())
+            o, s = np.fromfile(f, np.float64, 2)
+            offsets.append(o)
+            scales.append(s)
+        data = np.fromfile(f, np.float32, nf * n * n)
+    data = data.reshape(nf, n, n).astype(float)
+    for k in range(nf):
+        data[k] = offsets[k] + scales[k] * data[k]
+    return names, t, data
+
+# %% field -> (colormap, min, max), matching the old bview squares() calls
+RENDER = {
+    'b':   ('coolwarm', 0.80, 0.825),
+    'u.x': ('coolwarm', 0.0, 0.8),
+    'cw':  ('coolwarm', 0.0, 0.8),
+}
+
+file_dir = os.path.dirname(os.path.realpath(__file__))
+frame_dir = os.path.join(file_dir, "frames")
+png_dir = os.path.join(frame_dir, "png")
+os.makedirs(png_dir, exist_ok=True)
+
+# %%
+for fname in sorted(glob.glob(os.path.join(frame_dir, "frame_*"))):
+    if not os.path.basename(fname).startswith("frame_"):
+        continue
+    nr = os.path.basename(fname).split('_')[1]
+    names, t, data = read_slice_v2(fname)
+    field = dict(zip(names, data))
+    # Mask: white out the roof interior, outline the canopy cubes
+    roof = field.get('ROOF')
+    cl = field.get('CL')
+    for name, (cmap, vmin, vmax) in RENDER.items():
+        if name not in field:
+            continue
+        img = field[name].T.copy()
+        if roof is not None:
+            img[roof.T > 0.5] = np.nan
+        fig, ax = plt.subplots(figsize=(6, 6))
+        ax.imshow(img, origin='lower', cmap=cmap, vmin=vmin, vmax=vmax)
+        if cl is not None:
+            ax.contour(cl.T, levels=[0.5], colors='green', linewidths=1)
+        if roof is not None:
+            ax.contour(roof.T, levels=[0.5], colors='black', linewidths=1)
+        ax.set_title(f"{name}  t={t:g}")
+        ax.set_axis_off()
+        out = os.path.join(png_dir, f"{name.replace('.', '')}_{nr}.png")
+        plt.savefig(out, dpi=150, bbox_inches='tight')
+        plt.close(fig)
+    print(f"rendered frame {nr} (t={t:g})")
+
+print("assemble with e.g.: ffmpeg -framerate 10 -i frames/png/b_%04d.png b.mp4")
+# %%
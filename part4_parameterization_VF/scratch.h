@@ -0,0 +1,50 @@
+/**
+ * scratch.h - Reusable scratch-field arena for per-event temporaries
+ *
+ * Temporary full-domain scalars declared inside events (noise fields,
+ * diffusion source terms, ...) are allocated and freed every iteration,
+ * touching the whole tree and churning the allocator. This header keeps
+ * a small pool of permanently allocated scalars that events check out
+ * and release instead, so steady-state runs perform zero per-step field
+ * allocations.
+ *
+ * Contract: a checked-out field still holds whatever its previous user
+ * left in it - callers must fully overwrite it (this is deliberate: it
+ * is the skip-initialization that makes checkout free). Pool fields are
+ * flagged nodump so they never leak into restart files.
+ */
+
+#define SCRATCH_MAX 4                // Concurrent temporaries we can serve
+scalar scratch0[], scratch1[], scratch2[], scratch3[];
+static bool scratch_used[SCRATCH_MAX];
+
+// ============================================================
+// FUNCTION: scratch_checkout - Borrow a scalar from the pool
+// ============================================================
+scalar scratch_checkout (void)
+{
+    scalar pool[SCRATCH_MAX] = {scratch0, scratch1, scratch2, scratch3};
+    for (int s = 0; s < SCRATCH_MAX; s++)
+        if (!scratch_used[s]) {
+            scratch_used[s] = true;
+            scalar f = pool[s];
+            f.nodump = true;         // Scratch contents are meaningless
+            return f;
+        }
+    assert (false);                  // Pool exhausted: grow SCRATCH_MAX
+    return scratch0;
+}
+
+// ============================================================
+// FUNCTION: scratch_release - Return a scalar to the pool
+// ============================================================
+void scratch_release (scalar f)
+{
+    scalar pool[SCRATCH_MAX] = {scratch0, scratch1, scratch2, scratch3};
+    for (int s = 0; s < SCRATCH_MAX; s++)
+        if (pool[s].i == f.i) {
+            scratch_used[s] = false;
+            return;
+        }
+    assert (false);                  // Not a pool field
+}
@@ -0,0 +1,163 @@
+/**
+ * solver_control.h - Tolerance, warm starts and cycle accounting for
+ * the implicit solves
+ *
+ * Every step runs the pressure projection plus the implicit diffusion
+ * solves with the stock fixed TOLERANCE, starting each multigrid solve
+ * from the previous field, and the returned mgstats went unused. This
+ * header adds three things:
+ *
+ *   - an adaptive TOLERANCE tied to the current dt: there is no point
+ *     iterating the solver orders of magnitude below the backward-Euler
+ *     truncation error of the step;
+ *   - time-extrapolated warm starts: the last two solutions of a
+ *     registered field give a linear-in-time initial guess, which in
+ *     quasi-steady phases starts the solver much closer to the answer
+ *     than the previous solution alone (diffusion_list.h hooks these
+ *     in between building the right-hand side and calling mg_solve);
+ *   - multigrid cycle accounting: solver_mg_log() accumulates solve
+ *     and V-cycle counts per named solve, reported next to the perf
+ *     sections by solver_mg_report().
+ */
+
+#include "poisson.h"
+
+// ============================================================
+// ADAPTIVE TOLERANCE
+// ============================================================
+// Calibrated against the stock TOLERANCE of 1e-3: the CFL-limited step
+// of the greenhouse cases sits around a few tenths of a second, so the
+// coefficient is chosen to land at or above 1e-3 there and relax
+// further when dt grows - a clamp range that can only tighten would
+// buy extra V-cycles for accuracy the time discretisation cannot use.
+// The floor still guards against over-tightening during the tiny
+// start-up steps.
+#define SOLVER_TOL_COEF 5e-3         // TOLERANCE = coef * dt, clamped
+#define SOLVER_TOL_MIN 1e-4
+#define SOLVER_TOL_MAX 1e-2
+
+// Runs at the end of each step: sets the tolerance all implicit solves
+// of the next step will use (dt varies slowly, so the one-step lag is
+// immaterial)
+event solver_tolerance(i++)
+{
+    if (dt > 0.)
+        TOLERANCE = clamp(SOLVER_TOL_COEF*dt, SOLVER_TOL_MIN, SOLVER_TOL_MAX);
+}
+
+// ============================================================
+// TIME-EXTRAPOLATED WARM STARTS
+// ============================================================
+typedef struct {
+    scalar f;                        // The solved field
+    scalar p1, p2;                   // Its last two solutions
+    double t1, t2;                   // Times of p1 and p2
+} SolverWarm;
+
+#define SOLVER_WARM_MAX 8
+SolverWarm solver_warm[SOLVER_WARM_MAX];
+int solver_warm_n = 0;
+
+// Find or lazily create the warm-start slot of f
+static SolverWarm * solver_warm_get(scalar f)
+{
+    for (int w = 0; w < solver_warm_n; w++)
+        if (solver_warm[w].f.i == f.i)
+            return &solver_warm[w];
+    assert (solver_warm_n < SOLVER_WARM_MAX);
+    SolverWarm * w = &solver_warm[solver_warm_n++];
+    w->f = f;
+    scalar p1 = new scalar, p2 = new scalar;
+    p1.nodump = p2.nodump = true;
+    w->p1 = p1, w->p2 = p2;
+    w->t1 = w->t2 = -HUGE;
+    return w;
+}
+
+// Overwrite each field with the linear-in-time extrapolation of its
+// last two solutions (no-op until two are recorded). Must be called
+// AFTER the right-hand side has been built from the old value - the
+// field is only an initial guess from here on.
+void solver_warm_start(scalar * fl)
+{
+    for (scalar f in fl) {
+        SolverWarm * w = solver_warm_get(f);
+        if (w->t2 > -HUGE && w->t1 > w->t2) {
+            double c = (t - w->t1)/(w->t1 - w->t2);
+            scalar p1 = w->p1, p2 = w->p2;
+            foreach()
+                f[] = p1[] + c*(p1[] - p2[]);
+        }
+    }
+}
+
+// Record the converged solutions for the next extrapolation
+void solver_warm_record(scalar * fl)
+{
+    for (scalar f in fl) {
+        SolverWarm * w = solver_warm_get(f);
+        scalar tmp = w->p2;          // Rotate the two history buffers
+        w->p2 = w->p1, w->p1 = tmp;
+        w->t2 = w->t1;
+        scalar p1 = w->p1;
+        foreach()
+            p1[] = f[];
+        w->t1 = t;
+    }
+}
+
+// ============================================================
+// MULTIGRID CYCLE ACCOUNTING
+// ============================================================
+typedef struct {
+    const char * name;               // Solve label
+    long solves;                     // Number of solves
+    long cycles;                     // Accumulated V-cycles (mgstats.i)
+    int imax;                        // Worst single solve
+} SolverMG;
+
+#define SOLVER_MG_MAX 8
+SolverMG solver_mg[SOLVER_MG_MAX];
+int solver_mg_n = 0;
+
+void solver_mg_log(const char * name, mgstats s)
+{
+    SolverMG * m = NULL;
+    for (int q = 0; q < solver_mg_n; q++)
+        if (!strcmp(solver_mg[q].name, name))
+            m = &solver_mg[q];
+    if (!m) {
+        assert (solver_mg_n < SOLVER_MG_MAX);
+        m = &solver_mg[solver_mg_n++];
+        m->name = name;
+        m->solves = m->cycles = 0, m->imax = 0;
+    }
+    m->solves++;
+    m->cycles += s.i;
+    if (s.i > m->imax)
+        m->imax = s.i;
+}
+
+// One machine-readable line per solve label, same register as the
+// "perf:" lines
+void solver_mg_report(FILE * fp)
+{
+    if (pid() == 0) {
+        for (int q = 0; q < solver_mg_n; q++)
+            fprintf(fp, "mg: i=%d t=%g name=%s solves=%ld cycles=%ld "
+                    "avg=%.2f max=%d\n",
+                    i, t, solver_mg[q].name, solver_mg[q].solves,
+                    solver_mg[q].cycles,
+                    solver_mg[q].solves ?
+                    (double) solver_mg[q].cycles/solver_mg[q].solves : 0.,
+                    solver_mg[q].imax);
+        fflush(fp);
+    }
+}
+
+// Projection and viscous-solve statistics from centered.h
+event solver_mg_monitor(i++)
+{
+    solver_mg_log("projection", mgp);
+    solver_mg_log("viscosity", mgu);
+}